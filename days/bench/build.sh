@@ -0,0 +1,3 @@
+
+g++ -O3 -std=c++17 -o run run.cpp
+g++ -O3 -std=c++17 -o stages stages.cpp
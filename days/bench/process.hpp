@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+// One run of a child process
+struct Sample{
+    double wall_ms;
+    long max_rss_kb;
+    int status;      // exit code, or -1 when killed
+    int signal;      // what killed it, or 0
+    bool timed_out;  // killed by the timeout
+};
+
+/*
+ * Running a child with a timeout
+ *
+ * The child gets its own process group, so that the whole compiler pipeline
+ * can be killed when the alarm goes off
+ */
+static volatile std::sig_atomic_t child_group = 0;
+static volatile std::sig_atomic_t alarm_fired = 0;
+
+extern "C" inline void on_alarm(int) noexcept{
+    if(child_group > 0){
+        alarm_fired = 1;
+        kill(-child_group, SIGKILL);
+    }
+}
+
+inline double elapsed_ms(timespec const& begin, timespec const& end) noexcept{
+    return double(end.tv_sec - begin.tv_sec) * 1e3 + double(end.tv_nsec - begin.tv_nsec) / 1e6;
+}
+
+// What the child prints is thrown away, unless `errors` names a file for
+// its stderr to go to
+inline Sample run_child(std::string const& dir, std::vector<std::string> const& args, unsigned timeout,
+                        std::string const& errors = {}) noexcept{
+    auto argv = std::vector<char*>{};
+    for(auto const& arg : args){
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    timespec begin{}, end{};
+    std::fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    auto pid = fork();
+    if(pid < 0){
+        std::perror("fork");
+        return {0, 0, -1, 0, false};
+    }
+    if(pid == 0){
+        setpgid(0, 0);
+        if(chdir(dir.c_str()) != 0){
+            std::perror(dir.c_str());
+            _exit(127);
+        }
+        // Only the measurements are of interest, not the answers or the
+        // compiler's diagnostics - a failure shows up in the status
+        auto null = open("/dev/null", O_WRONLY);
+        if(null >= 0){
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+        }
+        if(!errors.empty()){
+            auto file = open(errors.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(file >= 0){
+                dup2(file, STDERR_FILENO);
+            }
+        }
+        execvp(argv[0], argv.data());
+        std::perror(argv[0]);
+        _exit(127);
+    }
+    setpgid(pid, pid);
+    child_group = pid;
+    alarm_fired = 0;
+    alarm(timeout);
+
+    int status = 0;
+    struct rusage usage{};
+    while(wait4(pid, &status, 0, &usage) < 0 && errno == EINTR);
+    alarm(0);
+    child_group = 0;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    auto code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    auto signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    return {elapsed_ms(begin, end), usage.ru_maxrss, code, signal, alarm_fired != 0};
+}
@@ -0,0 +1,266 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "process.hpp"
+
+/*
+ * Benchmark harness - builds and runs every day, measuring what the build
+ * costs in the compiler separately from what the solution costs at runtime
+ *
+ *     ./run [-c compile reps] [-r run reps] [-t timeout] [-i input dir]
+ *           [-j threads,...] [-d days dir] [-o report dir] [day...]
+ *
+ * Each day is built with its own `build.sh` (so with its own limits), then
+ * `./run` is timed, and `./run <input dir>/day_NN.txt` too when given
+ * With `-j` the days that take a thread count after their input are also
+ * timed at each of the thread counts listed, to show how they scale
+ * For every day a `day_NN.json` summary and a `day_NN.csv` of the raw
+ * samples are written to the report directory
+ */
+
+struct Options{
+    unsigned compile_reps = 1;
+    unsigned run_reps = 10;
+    unsigned timeout = 0; // seconds, 0 for none
+    std::string input_dir;
+    std::string days_dir = "..";
+    std::string report_dir = "reports";
+    std::vector<unsigned> threads;
+    std::vector<unsigned> days;
+};
+
+// The days whose `./run <input> <threads>` splits the work across threads
+constexpr static unsigned threaded_days[] = {2, 3, 4, 6};
+
+// Peak RSS is reported by `wait4` for the child and all of its own waited for
+// children, which for `g++` includes `cc1plus` and the linker
+struct Summary{
+    double min_ms, p50_ms, p90_ms, p99_ms, max_ms, mean_ms;
+    long max_rss_kb;
+    unsigned failures;
+};
+
+/*
+ * Statistics - nearest rank percentiles over the successful samples
+ */
+inline double percentile(std::vector<double> const& sorted, double p) noexcept{
+    auto rank = std::size_t(p / 100.0 * double(sorted.size()) + 0.999999);
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+inline Summary summarise(std::vector<Sample> const& samples) noexcept{
+    auto summary = Summary{};
+    auto times = std::vector<double>{};
+    for(auto const& sample : samples){
+        if(sample.status != 0){
+            ++summary.failures;
+            continue;
+        }
+        times.push_back(sample.wall_ms);
+        summary.max_rss_kb = std::max(summary.max_rss_kb, sample.max_rss_kb);
+    }
+    if(times.empty()){
+        return summary;
+    }
+    std::sort(times.begin(), times.end());
+    summary.min_ms = times.front();
+    summary.p50_ms = percentile(times, 50);
+    summary.p90_ms = percentile(times, 90);
+    summary.p99_ms = percentile(times, 99);
+    summary.max_ms = times.back();
+    for(auto time : times){
+        summary.mean_ms += time;
+    }
+    summary.mean_ms /= double(times.size());
+    return summary;
+}
+
+/*
+ * Reports
+ */
+inline void print_summary(std::FILE* file, char const* name, std::vector<Sample> const& samples, bool last) noexcept{
+    auto s = summarise(samples);
+    std::fprintf(file,
+        "  \"%s\": {\"reps\": %lu, \"failures\": %u, \"min_ms\": %.3f, \"p50_ms\": %.3f, "
+        "\"p90_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f, \"mean_ms\": %.3f, "
+        "\"max_rss_kb\": %ld}%s\n",
+        name, samples.size(), s.failures, s.min_ms, s.p50_ms, s.p90_ms, s.p99_ms,
+        s.max_ms, s.mean_ms, s.max_rss_kb, last ? "" : ",");
+}
+
+inline void print_samples(std::FILE* file, char const* name, std::vector<Sample> const& samples) noexcept{
+    for(std::size_t i = 0; i < samples.size(); ++i){
+        std::fprintf(file, "%s,%lu,%.3f,%ld,%d\n",
+            name, i, samples[i].wall_ms, samples[i].max_rss_kb, samples[i].status);
+    }
+}
+
+inline bool write_reports(Options const& options, unsigned day, long binary_size,
+                          std::vector<Sample> const& compile,
+                          std::vector<Sample> const& run,
+                          std::vector<Sample> const& run_input,
+                          std::vector<std::vector<Sample>> const& scaling) noexcept{
+    char name[16];
+    std::snprintf(name, sizeof(name), "day_%02u", day);
+    auto base = options.report_dir + "/" + name;
+
+    auto* json = std::fopen((base + ".json").c_str(), "w");
+    if(!json){
+        std::perror((base + ".json").c_str());
+        return false;
+    }
+    std::fprintf(json, "{\n  \"day\": %u,\n  \"binary_size\": %ld,\n", day, binary_size);
+    print_summary(json, "compile", compile, false);
+    print_summary(json, "run", run, run_input.empty() && scaling.empty());
+    if(!run_input.empty()){
+        print_summary(json, "run_input", run_input, scaling.empty());
+    }
+    char phase[32];
+    for(std::size_t i = 0; i < scaling.size(); ++i){
+        std::snprintf(phase, sizeof(phase), "threads_%u", options.threads[i]);
+        print_summary(json, phase, scaling[i], i + 1 == scaling.size());
+    }
+    std::fprintf(json, "}\n");
+    std::fclose(json);
+
+    auto* csv = std::fopen((base + ".csv").c_str(), "w");
+    if(!csv){
+        std::perror((base + ".csv").c_str());
+        return false;
+    }
+    std::fprintf(csv, "phase,rep,wall_ms,max_rss_kb,status\n");
+    print_samples(csv, "compile", compile);
+    print_samples(csv, "run", run);
+    print_samples(csv, "run_input", run_input);
+    for(std::size_t i = 0; i < scaling.size(); ++i){
+        std::snprintf(phase, sizeof(phase), "threads_%u", options.threads[i]);
+        print_samples(csv, phase, scaling[i]);
+    }
+    std::fclose(csv);
+    return true;
+}
+
+/*
+ * Benchmarking one day
+ */
+inline bool bench_day(Options const& options, unsigned day) noexcept{
+    char name[16];
+    std::snprintf(name, sizeof(name), "day_%02u", day);
+    auto dir = options.days_dir + "/" + name;
+
+    auto compile = std::vector<Sample>{};
+    for(unsigned i = 0; i < options.compile_reps; ++i){
+        compile.push_back(run_child(dir, {"sh", "build.sh"}, options.timeout));
+    }
+    auto built = std::any_of(compile.begin(), compile.end(), [](auto const& sample){
+        return sample.status == 0;
+    });
+
+    long binary_size = 0;
+    auto run = std::vector<Sample>{};
+    auto run_input = std::vector<Sample>{};
+    auto scaling = std::vector<std::vector<Sample>>{};
+    auto threaded = std::find(std::begin(threaded_days), std::end(threaded_days), day) != std::end(threaded_days);
+    if(built){
+        struct stat info{};
+        if(stat((dir + "/run").c_str(), &info) == 0){
+            binary_size = long(info.st_size);
+        }
+        for(unsigned i = 0; i < options.run_reps; ++i){
+            run.push_back(run_child(dir, {"./run"}, options.timeout));
+        }
+        if(!options.input_dir.empty()){
+            auto input = std::filesystem::absolute(options.input_dir + "/" + name + ".txt").string();
+            for(unsigned i = 0; i < options.run_reps; ++i){
+                run_input.push_back(run_child(dir, {"./run", input}, options.timeout));
+            }
+            for(auto threads : (threaded ? options.threads : std::vector<unsigned>{})){
+                scaling.emplace_back();
+                for(unsigned i = 0; i < options.run_reps; ++i){
+                    scaling.back().push_back(run_child(dir, {"./run", input, std::to_string(threads)}, options.timeout));
+                }
+            }
+        }
+    }
+
+    auto c = summarise(compile);
+    auto r = summarise(run);
+    std::printf("%s  compile %9.1f ms %8ld KiB  binary %8ld B  run p50 %9.3f ms p99 %9.3f ms %8ld KiB%s\n",
+        name, c.p50_ms, c.max_rss_kb, binary_size, r.p50_ms, r.p99_ms, r.max_rss_kb,
+        built ? "" : "  (build failed)");
+    if(!scaling.empty()){
+        auto base = summarise(scaling[0]).p50_ms;
+        std::printf("%s  scaling", name);
+        for(std::size_t i = 0; i < scaling.size(); ++i){
+            auto p50 = summarise(scaling[i]).p50_ms;
+            std::printf("  %u: %.3f ms (%.2fx)", options.threads[i], p50, p50 > 0 ? base / p50 : 0.0);
+        }
+        std::printf("\n");
+    }
+    return write_reports(options, day, binary_size, compile, run, run_input, scaling) && built;
+}
+
+inline void usage(char const* self) noexcept{
+    std::fprintf(stderr,
+        "usage: %s [-c compile reps] [-r run reps] [-t timeout seconds] [-i input dir]\n"
+        "          [-j threads,...] [-d days dir] [-o report dir] [day...]\n", self);
+}
+
+int main(int argc, char** argv){
+    auto options = Options{};
+    for(int opt; (opt = getopt(argc, argv, "c:r:t:i:j:d:o:h")) != -1;){
+        switch(opt){
+            case 'c': options.compile_reps = unsigned(std::strtoul(optarg, nullptr, 10)); break;
+            case 'r': options.run_reps = unsigned(std::strtoul(optarg, nullptr, 10)); break;
+            case 't': options.timeout = unsigned(std::strtoul(optarg, nullptr, 10)); break;
+            case 'i': options.input_dir = optarg; break;
+            case 'j':
+                for(char* str = optarg; *str != '\0'; str += (*str == ',')){
+                    char* next = str;
+                    auto threads = unsigned(std::strtoul(str, &next, 10));
+                    if(next == str){
+                        usage(argv[0]);
+                        return 2;
+                    }
+                    options.threads.push_back(threads);
+                    str = next;
+                }
+                break;
+            case 'd': options.days_dir = optarg; break;
+            case 'o': options.report_dir = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    for(int i = optind; i < argc; ++i){
+        options.days.push_back(unsigned(std::strtoul(argv[i], nullptr, 10)));
+    }
+    if(options.days.empty()){
+        for(unsigned day = 1; day <= 25; ++day){
+            options.days.push_back(day);
+        }
+    }
+    if(options.compile_reps == 0){
+        options.compile_reps = 1;
+    }
+
+    std::signal(SIGALRM, on_alarm);
+    std::error_code error;
+    std::filesystem::create_directories(options.report_dir, error);
+    if(error){
+        std::fprintf(stderr, "%s: %s\n", options.report_dir.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    auto failures = 0;
+    for(auto day : options.days){
+        failures += !bench_day(options, day);
+    }
+    return failures == 0 ? 0 : 1;
+}
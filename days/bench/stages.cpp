@@ -0,0 +1,477 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <unistd.h>
+#include "process.hpp"
+
+/*
+ * Compile-time budget per stage - how much of a day's build each of its
+ * top-level `constexpr static` results costs
+ *
+ *     ./stages [-c compile reps] [-t timeout] [-d days dir] [-o report dir]
+ *              [day...]
+ *
+ * A day is compiled as it is, then once per stage with that stage moved to
+ * runtime (its initializer made non-constant), all with the day's own
+ * `build.sh` flags plus `-ftime-report` and `-fno-inline` (without which GCC
+ * folds calls to constexpr functions with constant arguments even outside of
+ * constant expressions, so the moved stage would still be evaluated)
+ * What moving a stage saves - in wall time, in the compiler's "template
+ * instantiation" and "constant expression evaluation" timers and in peak
+ * RSS - is that stage's cost, including any template instantiation chains
+ * only its evaluation needs
+ * Later stages that use a stage move along with it, and a stage that is still
+ * needed at compile time (as a template argument, say) is reported as pinned
+ * Only a compile error naming a moved stage pins it: a probe build that times
+ * out, is killed by a signal, crashes the compiler or runs into one of its
+ * limits is reported as failed, with why, and fails the run
+ * A solver lambda handed to `evaluate` (see common/evaluate.hpp) is a stage
+ * as well, moved to runtime by giving its `evaluate` calls a limit of 0
+ *
+ * For every day a `day_NN.stages.json` is written to the report directory
+ */
+
+struct Options{
+    unsigned compile_reps = 1;
+    unsigned timeout = 0; // seconds, 0 for none
+    std::string days_dir = "..";
+    std::string report_dir = "reports";
+    std::vector<unsigned> days;
+};
+
+struct Stage{
+    std::string name;
+    std::size_t line;
+    std::size_t begin, end;  // the statement, up to and including the ';'
+    std::size_t type, named; // where the type and the name start
+    bool solver;             // a lambda for `evaluate`
+};
+
+// Why a build failed
+enum class Failure{
+    none,
+    timeout,  // killed when the timeout ran out
+    signal,   // killed by a signal, or the compiler by one
+    crash,    // an internal compiler error
+    limit,    // the template depth or constexpr operation limit
+    error     // any other compile error
+};
+
+constexpr static char const* failure_names[] = {"none", "timeout", "signal", "crash", "limit", "error"};
+
+// One build, with the best of the repetitions
+struct Build{
+    int status;
+    double wall_ms;
+    double template_ms;
+    double constexpr_ms;
+    long max_rss_kb;
+    Failure failure;
+    std::vector<std::string> errors; // the compiler's "error:" lines, when it failed
+};
+
+/*
+ * Finding the stages
+ */
+inline bool is_identifier(char c) noexcept{
+    return c == '_' || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9');
+}
+
+// The ';' ending the statement at `i`, skipping over literals and brackets
+inline std::size_t statement_end(std::string const& source, std::size_t i) noexcept{
+    auto depth = 0;
+    for(; i < source.size(); ++i){
+        auto c = source[i];
+        if(c == '"' || c == '\''){
+            for(++i; i < source.size() && source[i] != c; ++i){
+                i += (source[i] == '\\');
+            }
+        } else if(c == '(' || c == '{' || c == '['){
+            ++depth;
+        } else if(c == ')' || c == '}' || c == ']'){
+            --depth;
+        } else if(c == ';' && depth == 0){
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+inline std::vector<Stage> find_stages(std::string const& source) noexcept{
+    constexpr auto prefix = std::string_view{"constexpr static "};
+    auto stages = std::vector<Stage>{};
+    std::size_t line = 1;
+    for(std::size_t i = 0; i < source.size(); ++i){
+        auto at_line_start = (i == 0 || source[i - 1] == '\n');
+        if(at_line_start && std::string_view{source}.substr(i, prefix.size()) == prefix){
+            auto end = statement_end(source, i);
+            auto equals = source.find('=', i);
+            if(end == std::string::npos || equals > end){
+                continue;
+            }
+            auto named = equals;
+            while(named > i && !is_identifier(source[named - 1])){
+                --named;
+            }
+            auto name_end = named;
+            while(named > i && is_identifier(source[named - 1])){
+                --named;
+            }
+            auto name = source.substr(named, name_end - named);
+            auto value = source.find_first_not_of(" \t\r\n", equals + 1);
+            auto solver = (source[value] == '[');
+            if(!solver || source.find(", " + name + ">()") != std::string::npos){
+                stages.push_back({name, line, i, end, i + prefix.size(), named, solver});
+            }
+            line += std::size_t(std::count(source.begin() + i, source.begin() + end, '\n'));
+            i = end;
+            continue;
+        }
+        line += (source[i] == '\n');
+    }
+    return stages;
+}
+
+/*
+ * `constexpr static T name = e;` becomes `static T const name = (..., e);`,
+ * where the call in front stops the compiler from evaluating `e` at compile
+ * time, as it would otherwise try to for any static initializer
+ */
+constexpr static char const* barrier = "inline int stage_barrier() noexcept{ return 0; }\n";
+
+inline std::string move_to_runtime(std::string const& source, std::vector<Stage> const& stages,
+                                   std::vector<bool> const& moving) noexcept{
+    auto result = std::string{barrier};
+    std::size_t copied = 0;
+    for(std::size_t i = 0; i < stages.size(); ++i){
+        if(!moving[i] || stages[i].solver){
+            continue;
+        }
+        auto const& stage = stages[i];
+        auto equals = source.find('=', stage.named);
+        result.append(source, copied, stage.begin - copied);
+        result += "static ";
+        result.append(source, stage.type, stage.named - stage.type);
+        result += "const ";
+        result.append(source, stage.named, equals + 1 - stage.named);
+        result += " (void(stage_barrier()), ";
+        result.append(source, equals + 1, stage.end - equals - 1);
+        result += ")";
+        copied = stage.end;
+    }
+    result.append(source, copied, std::string::npos);
+
+    // `evaluate<input, solver>()` becomes `evaluate<input, solver, 0>()`
+    for(std::size_t i = 0; i < stages.size(); ++i){
+        if(!moving[i] || !stages[i].solver){
+            continue;
+        }
+        auto call = ", " + stages[i].name + ">()";
+        for(auto at = result.find(call); at != std::string::npos; at = result.find(call, at)){
+            result.replace(at, call.size(), ", " + stages[i].name + ", 0>()");
+            at += call.size();
+        }
+    }
+    return result;
+}
+
+/*
+ * A stage can only move to runtime along with every later stage that uses it,
+ * so these move with it
+ */
+inline bool uses(std::string const& source, Stage const& stage, std::string const& name) noexcept{
+    auto i = source.find('=', stage.named);
+    while((i = source.find(name, i)) < stage.end){
+        auto end = i + name.size();
+        if(!is_identifier(source[i - 1]) && !is_identifier(source[end])){
+            return true;
+        }
+        i = end;
+    }
+    return false;
+}
+
+inline std::vector<bool> dependents(std::string const& source, std::vector<Stage> const& stages, std::size_t i) noexcept{
+    auto moving = std::vector<bool>(stages.size(), false);
+    moving[i] = true;
+    for(auto j = i + 1; j < stages.size(); ++j){
+        for(auto k = i; k < j && !moving[j]; ++k){
+            moving[j] = moving[k] && uses(source, stages[j], stages[k].name);
+        }
+    }
+    return moving;
+}
+
+/*
+ * Building
+ */
+inline std::vector<std::string> read_build_flags(std::string const& dir) noexcept{
+    auto file = std::ifstream{dir + "/build.sh"};
+    auto line = std::string{};
+    auto flags = std::vector<std::string>{};
+    while(std::getline(file, line)){
+        auto words = std::istringstream{line};
+        auto word = std::string{};
+        if(!(words >> word) || word != "g++"){
+            continue;
+        }
+        while(words >> word){
+            if(word == "-o"){
+                words >> word;
+            } else if(word.size() < 4 || word.compare(word.size() - 4, 4, ".cpp") != 0){
+                flags.push_back(word);
+            }
+        }
+        break;
+    }
+    return flags;
+}
+
+// The wall time (in ms) of a timer in the output of `-ftime-report`
+inline double read_timer(std::string const& report, char const* name) noexcept{
+    auto i = report.find(name);
+    if(i == std::string::npos){
+        return 0;
+    }
+    auto colon = report.find(':', i);
+    double usr = 0, sys = 0, wall = 0;
+    std::sscanf(report.c_str() + colon + 1, "%lf ( %*[^)]) %lf ( %*[^)]) %lf", &usr, &sys, &wall);
+    return wall * 1e3;
+}
+
+inline Failure failure_of(Sample const& sample, std::string const& report) noexcept{
+    if(sample.timed_out){
+        return Failure::timeout;
+    }
+    if(sample.signal != 0){
+        return Failure::signal;
+    }
+    if(report.find("internal compiler error") != std::string::npos){
+        return Failure::crash;
+    }
+    if(report.find("-fconstexpr-ops-limit") != std::string::npos ||
+       report.find("-fconstexpr-loop-limit") != std::string::npos ||
+       report.find("-fconstexpr-depth") != std::string::npos ||
+       report.find("-ftemplate-depth") != std::string::npos){
+        return Failure::limit;
+    }
+    return Failure::error;
+}
+
+inline Build build(Options const& options, std::string const& dir, std::vector<std::string> const& flags,
+                   std::string const& file) noexcept{
+    auto args = std::vector<std::string>{"g++"};
+    args.insert(args.end(), flags.begin(), flags.end());
+    args.insert(args.end(), {"-fno-inline", "-ftime-report", "-c", file, "-o", "/dev/null"});
+    auto log = (std::filesystem::temp_directory_path() / "stages.log").string();
+
+    auto best = Build{-1, 0, 0, 0, 0, Failure::error, {}};
+    for(unsigned i = 0; i < options.compile_reps; ++i){
+        auto sample = run_child(dir, args, options.timeout, log);
+        auto report = std::string{};
+        {
+            auto stream = std::ifstream{log};
+            report.assign(std::istreambuf_iterator<char>{stream}, {});
+        }
+        if(sample.status != 0){
+            best = {sample.status, sample.wall_ms, 0, 0, sample.max_rss_kb, failure_of(sample, report), {}};
+            auto lines = std::istringstream{report};
+            for(auto line = std::string{}; std::getline(lines, line);){
+                if(line.find("error:") != std::string::npos){
+                    best.errors.push_back(line);
+                }
+            }
+            break;
+        }
+        if(best.status != 0 || sample.wall_ms < best.wall_ms){
+            best = {0, sample.wall_ms, read_timer(report, "template instantiation"),
+                    read_timer(report, "constant expression evaluation"), sample.max_rss_kb, Failure::none, {}};
+        }
+    }
+    std::filesystem::remove(log);
+    return best;
+}
+
+/*
+ * A stage is pinned when a probe fails to compile with an error naming one
+ * of the stages it moved, which is then used where a constant is needed
+ */
+inline bool names(std::string const& line, std::string const& name) noexcept{
+    for(auto i = line.find(name); i != std::string::npos; i = line.find(name, i + 1)){
+        auto end = i + name.size();
+        if((i == 0 || !is_identifier(line[i - 1])) && (end == line.size() || !is_identifier(line[end]))){
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool pinned(Build const& b, std::vector<Stage> const& stages, std::vector<bool> const& moving) noexcept{
+    if(b.status == 0 || b.failure != Failure::error){
+        return false;
+    }
+    for(auto const& line : b.errors){
+        for(std::size_t i = 0; i < stages.size(); ++i){
+            if(moving[i] && names(line, stages[i].name)){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * Reports
+ */
+inline void print_build(std::FILE* file, Build const& b) noexcept{
+    std::fprintf(file, "{\"status\": %d, \"failure\": \"%s\", \"wall_ms\": %.1f, \"template_ms\": %.1f, "
+        "\"constexpr_ms\": %.1f, \"max_rss_kb\": %ld}",
+        b.status, failure_names[std::size_t(b.failure)], b.wall_ms, b.template_ms, b.constexpr_ms, b.max_rss_kb);
+}
+
+inline bool stages_of_day(Options const& options, unsigned day) noexcept{
+    char name[16];
+    std::snprintf(name, sizeof(name), "day_%02u", day);
+    auto dir = options.days_dir + "/" + name;
+    auto source = std::string{};
+    {
+        auto stream = std::ifstream{dir + "/run.cpp", std::ios::binary};
+        if(!stream){
+            std::perror((dir + "/run.cpp").c_str());
+            return false;
+        }
+        source.assign(std::istreambuf_iterator<char>{stream}, {});
+    }
+    auto flags = read_build_flags(dir);
+    auto stages = find_stages(source);
+
+    auto full = build(options, dir, flags, "run.cpp");
+    std::printf("%s  full build %10.1f ms  template %9.1f ms  constexpr %9.1f ms %8ld KiB%s%s%s\n",
+        name, full.wall_ms, full.template_ms, full.constexpr_ms, full.max_rss_kb,
+        full.status == 0 ? "" : "  (failed: ", full.status == 0 ? "" : failure_names[std::size_t(full.failure)],
+        full.status == 0 ? "" : ")");
+
+    auto probe = std::string{".stage_probe.cpp"};
+    auto moved = std::vector<Build>{};
+    auto with = std::vector<std::string>{}; // the stages moved along with each
+    auto pins = std::vector<bool>{};
+    auto failed = false;
+    for(auto const& stage : stages){
+        if(full.status != 0){
+            break;
+        }
+        auto moving = dependents(source, stages, moved.size());
+        {
+            auto stream = std::ofstream{dir + "/" + probe, std::ios::binary};
+            stream << move_to_runtime(source, stages, moving);
+        }
+        with.emplace_back();
+        for(std::size_t j = 0; j < stages.size(); ++j){
+            if(moving[j] && &stages[j] != &stage){
+                with.back() += (with.back().empty() ? "" : ", ") + stages[j].name;
+            }
+        }
+        moved.push_back(build(options, dir, flags, probe));
+        auto const& b = moved.back();
+        pins.push_back(pinned(b, stages, moving));
+        if(b.status == 0){
+            std::printf("    %-20s saves %10.1f ms  template %9.1f ms  constexpr %9.1f ms %8ld KiB%s%s\n",
+                stage.name.c_str(), full.wall_ms - b.wall_ms, full.template_ms - b.template_ms,
+                full.constexpr_ms - b.constexpr_ms, full.max_rss_kb - b.max_rss_kb,
+                with.back().empty() ? "" : "  with ", with.back().c_str());
+        } else if(pins.back()){
+            std::printf("    %-20s pinned (needed at compile time)\n", stage.name.c_str());
+        } else{
+            std::printf("    %-20s failed (%s)\n", stage.name.c_str(), failure_names[std::size_t(b.failure)]);
+            failed = true;
+        }
+    }
+    std::filesystem::remove(dir + "/" + probe);
+
+    auto path = options.report_dir + "/" + name + ".stages.json";
+    auto* json = std::fopen(path.c_str(), "w");
+    if(!json){
+        std::perror(path.c_str());
+        return false;
+    }
+    std::fprintf(json, "{\n  \"day\": %u,\n  \"flags\": \"", day);
+    for(std::size_t i = 0; i < flags.size(); ++i){
+        std::fprintf(json, "%s%s", i == 0 ? "" : " ", flags[i].c_str());
+    }
+    std::fprintf(json, "\",\n  \"full\": ");
+    print_build(json, full);
+    std::fprintf(json, ",\n  \"stages\": [");
+    for(std::size_t i = 0; i < moved.size(); ++i){
+        auto const& b = moved[i];
+        std::fprintf(json, "%s\n    {\"name\": \"%s\", \"line\": %lu, \"pinned\": %s, \"failure\": \"%s\", "
+            "\"saved_wall_ms\": %.1f, \"saved_template_ms\": %.1f, \"saved_constexpr_ms\": %.1f, \"saved_rss_kb\": %ld, "
+            "\"moved_with\": [",
+            i == 0 ? "" : ",", stages[i].name.c_str(), stages[i].line, pins[i] ? "true" : "false",
+            failure_names[std::size_t(b.failure)],
+            b.status == 0 ? full.wall_ms - b.wall_ms : 0.0,
+            b.status == 0 ? full.template_ms - b.template_ms : 0.0,
+            b.status == 0 ? full.constexpr_ms - b.constexpr_ms : 0.0,
+            b.status == 0 ? full.max_rss_kb - b.max_rss_kb : 0L);
+        auto names = std::string_view{with[i]};
+        while(!names.empty()){
+            auto end = std::min(names.find(", "), names.size());
+            std::fprintf(json, "%s\"%.*s\"", names.data() == with[i].data() ? "" : ", ",
+                int(end), names.data());
+            names.remove_prefix(std::min(end + 2, names.size()));
+        }
+        std::fprintf(json, "]}");
+    }
+    std::fprintf(json, "%s]\n}\n", moved.empty() ? "" : "\n  ");
+    std::fclose(json);
+    return full.status == 0 && !failed;
+}
+
+inline void usage(char const* self) noexcept{
+    std::fprintf(stderr,
+        "usage: %s [-c compile reps] [-t timeout seconds] [-d days dir] [-o report dir] [day...]\n", self);
+}
+
+int main(int argc, char** argv){
+    auto options = Options{};
+    for(int opt; (opt = getopt(argc, argv, "c:t:d:o:h")) != -1;){
+        switch(opt){
+            case 'c': options.compile_reps = unsigned(std::strtoul(optarg, nullptr, 10)); break;
+            case 't': options.timeout = unsigned(std::strtoul(optarg, nullptr, 10)); break;
+            case 'd': options.days_dir = optarg; break;
+            case 'o': options.report_dir = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    for(int i = optind; i < argc; ++i){
+        options.days.push_back(unsigned(std::strtoul(argv[i], nullptr, 10)));
+    }
+    if(options.days.empty()){
+        for(unsigned day = 1; day <= 25; ++day){
+            options.days.push_back(day);
+        }
+    }
+    if(options.compile_reps == 0){
+        options.compile_reps = 1;
+    }
+
+    std::signal(SIGALRM, on_alarm);
+    std::error_code error;
+    std::filesystem::create_directories(options.report_dir, error);
+    if(error){
+        std::fprintf(stderr, "%s: %s\n", options.report_dir.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    auto failures = 0;
+    for(auto day : options.days){
+        failures += !stages_of_day(options, day);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#ifdef TRACK_ALLOCATIONS
+#include <malloc.h>
+#endif
+
+/*
+ * Allocation accounting - a day built with `-DTRACK_ALLOCATIONS` counts every
+ * allocation, the bytes asked for and the peak of live bytes, both in total
+ * and per phase, and reports them to stderr when it exits
+ * The report is a summary, or one line of JSON with ALLOCATION_REPORT=json
+ *
+ *     {"total":{...},"phases":[{"name":"parse","count":N,"bytes":N,"peak":N},...]}
+ *
+ * A phase lasts from its `allocation_phase` until the next one, and those
+ * compile to nothing without the flag
+ * This replaces the global operator new and delete, so it is only meant for a
+ * day built on its own, not for the driver
+ */
+#ifdef TRACK_ALLOCATIONS
+namespace allocations{
+    struct Phase{
+        char const* name;
+        std::size_t count;
+        std::size_t bytes;
+        std::size_t peak;
+    };
+
+    inline Phase phases[16] = {{"startup", 0, 0, 0}};
+    inline std::size_t phase_count = 1;
+    inline Phase* current = phases;
+    inline Phase total = {"total", 0, 0, 0};
+    inline std::size_t live = 0;
+
+    inline void enter(char const* name) noexcept{
+        auto* phase = phases;
+        for(; phase != phases + phase_count && std::strcmp(phase->name, name) != 0; ++phase);
+        if(phase == phases + phase_count){
+            if(phase_count == std::size(phases)){
+                return;
+            }
+            *phase = {name, 0, 0, 0};
+            ++phase_count;
+        }
+        current = phase;
+        if(live > current->peak){
+            current->peak = live;
+        }
+    }
+
+    // Live bytes are counted as the allocator sees them, rounding included
+    inline void* allocate(std::size_t size){
+        auto* ptr = std::malloc(size == 0 ? 1 : size);
+        if(!ptr){
+            throw std::bad_alloc{};
+        }
+        live += malloc_usable_size(ptr);
+        for(auto* phase : {current, &total}){
+            ++phase->count;
+            phase->bytes += size;
+            if(live > phase->peak){
+                phase->peak = live;
+            }
+        }
+        return ptr;
+    }
+
+    inline void release(void* ptr) noexcept{
+        if(ptr){
+            live -= malloc_usable_size(ptr);
+            std::free(ptr);
+        }
+    }
+
+    inline void report() noexcept{
+        auto const* format = std::getenv("ALLOCATION_REPORT");
+        if(format && std::strcmp(format, "json") == 0){
+            std::fprintf(stderr, "{\"total\":{\"count\":%lu,\"bytes\":%lu,\"peak\":%lu},\"phases\":[",
+                total.count, total.bytes, total.peak);
+            for(std::size_t i = 0; i < phase_count; ++i){
+                std::fprintf(stderr, "%s{\"name\":\"%s\",\"count\":%lu,\"bytes\":%lu,\"peak\":%lu}",
+                    i == 0 ? "" : ",", phases[i].name, phases[i].count, phases[i].bytes, phases[i].peak);
+            }
+            std::fprintf(stderr, "]}\n");
+            return;
+        }
+        std::fprintf(stderr, "%-10s %12s %14s %14s\n", "phase", "allocations", "bytes", "peak live");
+        for(std::size_t i = 0; i < phase_count; ++i){
+            std::fprintf(stderr, "%-10s %12lu %14lu %14lu\n",
+                phases[i].name, phases[i].count, phases[i].bytes, phases[i].peak);
+        }
+        std::fprintf(stderr, "%-10s %12lu %14lu %14lu\n", total.name, total.count, total.bytes, total.peak);
+    }
+
+    inline auto const registered = std::atexit(report);
+}
+
+void* operator new(std::size_t size){
+    return allocations::allocate(size);
+}
+void* operator new[](std::size_t size){
+    return allocations::allocate(size);
+}
+void operator delete(void* ptr) noexcept{
+    allocations::release(ptr);
+}
+void operator delete[](void* ptr) noexcept{
+    allocations::release(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept{
+    allocations::release(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept{
+    allocations::release(ptr);
+}
+#endif
+
+/*
+ * Start the named phase, a string literal
+ * Usable from constexpr code, where it does nothing
+ */
+constexpr void allocation_phase([[maybe_unused]] char const* name) noexcept{
+#ifdef TRACK_ALLOCATIONS
+    if(!__builtin_is_constant_evaluated()){
+        allocations::enter(name);
+    }
+#endif
+}
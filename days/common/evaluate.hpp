@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/*
+ * Compile time or runtime - `evaluate<input, solve>()` is `solve(input)`,
+ * worked out by the compiler when the input has at most `limit` lines, so the
+ * answer costs nothing to run, and otherwise once at runtime, the first time
+ * it is asked for, so a large input does not blow up the build
+ *
+ *     constexpr static auto sum_of_all = [](auto const& array){ return sum_of_expressions<2, 1>(array); };
+ *     ...
+ *     auto const& result = evaluate<input, sum_of_all>();
+ *
+ * `input` and `solve` are `constexpr static` variables, the latter a lambda
+ * calling the day's solver
+ * The limit defaults to CONSTEXPR_INPUT_LIMIT lines, which every puzzle input
+ * is within (`-DCONSTEXPR_INPUT_LIMIT=0` solves every input at runtime), and a
+ * day whose cost has little to do with the size of its input gives its own
+ */
+#ifndef CONSTEXPR_INPUT_LIMIT
+#define CONSTEXPR_INPUT_LIMIT 4096
+#endif
+
+template<typename T, typename = void>
+struct is_grid : std::false_type{};
+
+template<typename T>
+struct is_grid<T, std::void_t<decltype(T::no_of_rows)>> : std::true_type{};
+
+// The elements of an array, the rows of a grid or the lines of a string
+template<typename Input>
+constexpr std::size_t input_lines(Input const& input) noexcept{
+    if constexpr(std::is_convertible_v<Input, char const*>){
+        std::size_t lines = 1;
+        for(char const* c = input; *c != '\0'; ++c){
+            lines += (*c == '\n');
+        }
+        return lines;
+    } else if constexpr(is_grid<Input>::value){
+        return Input::no_of_rows;
+    } else{
+        return std::size(input);
+    }
+}
+
+// Not constexpr, so that `solve` is not evaluated at compile time all the same,
+// as it would be for any static initializer the compiler is able to evaluate
+template<typename T>
+inline T const& at_runtime(T const& value) noexcept{
+    return value;
+}
+
+template<auto const& input, auto const& solve, std::size_t limit = CONSTEXPR_INPUT_LIMIT>
+inline auto const& evaluate() noexcept{
+    if constexpr(input_lines(input) <= limit){
+        constexpr static auto result = solve(input);
+        return result;
+    } else{
+        static auto const result = solve(at_runtime(input));
+        return result;
+    }
+}
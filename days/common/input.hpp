@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <optional>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Runtime input - an input file mapped into memory
+ *
+ * The mapping is private, so it can be written to without touching the file,
+ * and it always has one zeroed byte past the end of the file, so the whole
+ * text is a valid C string just like the `constexpr static` inputs
+ */
+struct Input{
+    Input(char* data, std::size_t size, std::size_t length) noexcept
+        : data{data}, size{size}, length{length}{}
+    Input(Input&& that) noexcept
+        : data{that.data}, size{that.size}, length{that.length}{
+        that.data = nullptr;
+    }
+    Input(Input const&) = delete;
+    Input& operator=(Input const&) = delete;
+    Input& operator=(Input&&) = delete;
+    ~Input() noexcept{
+        if(data){
+            munmap(data, length);
+        }
+    }
+
+    auto text() const noexcept{
+        return std::string_view{data, size};
+    }
+
+    char* data;
+    std::size_t size;   // size of the file
+    std::size_t length; // size of the mapping
+};
+
+/*
+ * Reserve enough anonymous (zeroed) memory for the file plus a terminating
+ * byte, then map the file over the start of it - this way the terminator
+ * exists even when the file size is a multiple of the page size
+ */
+inline std::optional<Input> map_input(char const* path) noexcept{
+    auto fd = open(path, O_RDONLY);
+    if(fd < 0){
+        std::perror(path);
+        return std::nullopt;
+    }
+    struct stat info{};
+    if(fstat(fd, &info) != 0){
+        std::perror(path);
+        close(fd);
+        return std::nullopt;
+    }
+    auto size = std::size_t(info.st_size);
+    auto length = size + 1;
+    auto* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED){
+        std::perror(path);
+        close(fd);
+        return std::nullopt;
+    }
+    if(size > 0){
+        auto* file = mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if(file == MAP_FAILED){
+            std::perror(path);
+            munmap(base, length);
+            close(fd);
+            return std::nullopt;
+        }
+    }
+    close(fd);
+    return Input{static_cast<char*>(base), size, length};
+}
+
+/*
+ * Line index - one view per line, pointing straight into the mapping
+ *
+ * Each newline is overwritten with '\0', so every view is also a C string
+ * and the `char const*` based solvers can be fed with `c_strs` below
+ * A trailing newline at the end of the file does not produce an empty line,
+ * matching the way the compiled inputs are written
+ */
+inline auto index_lines(Input& input) noexcept{
+    auto lines = std::vector<std::string_view>{};
+    auto* str = input.data;
+    auto* end = input.data + input.size;
+    while(str < end){
+        auto* line = str;
+        while(str < end && *str != '\n'){
+            ++str;
+        }
+        auto* last = str;
+        if(last > line && *(last - 1) == '\r'){
+            --last;
+        }
+        lines.emplace_back(line, std::size_t(last - line));
+        *last = '\0';
+        if(str < end){
+            *str = '\0';
+            ++str;
+        }
+    }
+    return lines;
+}
+
+inline auto c_strs(std::vector<std::string_view> const& lines) noexcept{
+    auto strs = std::vector<char const*>{};
+    strs.reserve(lines.size());
+    for(auto line : lines){
+        strs.push_back(line.data());
+    }
+    return strs;
+}
+
+/*
+ * Storage with one element per input element - a `std::array` for the
+ * compile-time inputs, a `std::vector` for the runtime ones
+ * `skip` leaves out that many leading elements, e.g. a header
+ */
+template<typename T, std::size_t skip = 0, typename U, std::size_t size>
+constexpr auto storage_for(std::array<U, size> const&) noexcept{
+    return std::array<T, size - skip>{};
+}
+
+template<typename T, std::size_t skip = 0, typename U>
+inline auto storage_for(std::vector<U> const& array) noexcept{
+    return std::vector<T>(array.size() - skip);
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <string_view>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Scalar parsing - one integer from the start of a C string
+ *
+ * Usable at compile time, and stops at the first character that is not a
+ * digit, handing it back through `endptr` (when given)
+ */
+template<typename T>
+constexpr T str_to(char const* str, char const** endptr) noexcept{
+    T i = 0;
+    for(; *str != '\0'; ++str){
+        char c = *str;
+        if('0' <= c && c <= '9'){
+            i = i * 10 + (c - '0');
+        } else{
+            if(endptr){
+                *endptr = str;
+            }
+            return i;
+        }
+    }
+    if(endptr){
+        *endptr = str;
+    }
+    return i;
+}
+
+/*
+ * The same, but allowing a leading '+' or '-'
+ */
+template<typename T>
+constexpr T str_to_signed(char const* str, char const** endptr) noexcept{
+    auto negative = (*str == '-');
+    if(negative || *str == '+'){
+        ++str;
+    }
+    auto i = str_to<T>(str, endptr);
+    return negative ? T(-i) : i;
+}
+
+constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
+    return str_to<std::int32_t>(str, endptr);
+}
+
+constexpr std::int16_t str_to_int16(char const* str, char const** endptr) noexcept{
+    return str_to<std::int16_t>(str, endptr);
+}
+
+constexpr std::uint8_t str_to_uint8(char const* str, char const** endptr) noexcept{
+    return str_to<std::uint8_t>(str, endptr);
+}
+
+constexpr std::uint16_t str_to_uint16(char const* str, char const** endptr) noexcept{
+    return str_to<std::uint16_t>(str, endptr);
+}
+
+constexpr std::uint32_t str_to_uint32(char const* str, char const** endptr) noexcept{
+    return str_to<std::uint32_t>(str, endptr);
+}
+
+constexpr std::uint64_t str_to_uint64(char const* str, char const** endptr) noexcept{
+    return str_to<std::uint64_t>(str, endptr);
+}
+
+constexpr std::size_t str_to_size_t(char const* str, char const** endptr) noexcept{
+    return str_to<std::size_t>(str, endptr);
+}
+
+/*
+ * SWAR (SIMD within a register) - eight characters loaded into one
+ * little-endian word, so the first character is the lowest byte
+ */
+inline std::uint64_t load_eight(char const* str) noexcept{
+    std::uint64_t chunk;
+    std::memcpy(&chunk, str, sizeof(chunk));
+    return chunk;
+}
+
+// How many of the eight characters are digits before the first non-digit
+inline std::size_t leading_digits(std::uint64_t chunk) noexcept{
+    // A byte is a digit when its high nibble is 3 and adding 6 keeps it so
+    auto high = chunk & 0xF0F0F0F0F0F0F0F0;
+    auto carry = ((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4;
+    auto not_digits = (high | carry) ^ 0x3333333333333333;
+    return not_digits == 0 ? 8 : std::size_t(__builtin_ctzll(not_digits)) / 8;
+}
+
+// Eight digits into their value, by combining pairs, then quads, then the halves
+inline std::uint64_t parse_eight_digits(std::uint64_t chunk) noexcept{
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32)))
+          + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+    return chunk;
+}
+
+constexpr static std::uint64_t powers_of_ten[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+/*
+ * Parse the digits at `str`, never reading at or past `end`
+ * Eight digits are handled at a time while there is room for the load
+ */
+inline std::uint64_t parse_digits(char const*& str, char const* end) noexcept{
+    std::uint64_t i = 0;
+    while(end - str >= 8){
+        auto chunk = load_eight(str);
+        auto n = leading_digits(chunk);
+        if(n == 8){
+            i = i * powers_of_ten[8] + parse_eight_digits(chunk);
+            str += 8;
+            continue;
+        }
+        if(n > 0){
+            // Right align the digits, padding the front with '0's
+            chunk = (chunk << (8 * (8 - n))) | (0x3030303030303030 >> (8 * n));
+            i = i * powers_of_ten[n] + parse_eight_digits(chunk);
+            str += n;
+        }
+        return i;
+    }
+    for(; str < end && '0' <= *str && *str <= '9'; ++str){
+        i = i * 10 + std::uint64_t(*str - '0');
+    }
+    return i;
+}
+
+/*
+ * Digit classification - bit `i` of the result is set when `str[i]` is a
+ * digit, for the 64 characters at `str`
+ * Uses AVX2 or SSE2 when the compiler has been allowed to
+ */
+inline std::uint64_t digit_mask(char const* str) noexcept{
+#if defined(__AVX2__)
+    auto zero = _mm256_set1_epi8('0');
+    auto nine = _mm256_set1_epi8(9);
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 32){
+        auto chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(str + i));
+        auto value = _mm256_sub_epi8(chars, zero);
+        auto digits = _mm256_cmpeq_epi8(_mm256_min_epu8(value, nine), value);
+        mask |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(digits))) << i;
+    }
+    return mask;
+#elif defined(__SSE2__)
+    auto zero = _mm_set1_epi8('0');
+    auto nine = _mm_set1_epi8(9);
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 16){
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str + i));
+        auto value = _mm_sub_epi8(chars, zero);
+        auto digits = _mm_cmpeq_epi8(_mm_min_epu8(value, nine), value);
+        mask |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(digits))) << i;
+    }
+    return mask;
+#else
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; ++i){
+        mask |= std::uint64_t('0' <= str[i] && str[i] <= '9') << i;
+    }
+    return mask;
+#endif
+}
+
+/*
+ * Parse a run of `n` digits at `str` whose length is already known,
+ * falling back to `parse_digits` when the loads would pass `end`
+ * The run is moved to the top of the eight bytes and the bytes below it are
+ * filled with '0', none of them when the run already takes up all eight
+ */
+inline std::uint64_t parse_run(char const* str, std::size_t n, char const* end) noexcept{
+    if(n <= 8 && end - str >= 8){
+        auto fill = (n == 8 ? 0 : std::uint64_t(0x3030303030303030) >> (8 * n));
+        auto chunk = (load_eight(str) << (8 * (8 - n))) | fill;
+        return parse_eight_digits(chunk);
+    }
+    return parse_digits(str, end);
+}
+
+/*
+ * Bulk parsing - every run of digits in the text, in order, with any other
+ * characters acting as delimiters
+ * For signed types, a '-' directly before a run makes it negative
+ *
+ * Whole blocks of 64 characters are classified at once, so the parser jumps
+ * straight from one number to the start of the next, and already knows how
+ * long each number is unless it carries on into the next block
+ */
+template<typename T>
+inline void parse_integers(std::string_view text, std::vector<T>& values) noexcept{
+    auto const* begin = text.data();
+    auto const* end = begin + text.size();
+    auto sign = [&](char const* str, std::uint64_t i){
+        if constexpr(std::is_signed_v<T>){
+            if(str > begin && str[-1] == '-'){
+                return T(-T(i));
+            }
+        }
+        return T(i);
+    };
+    auto const* block = begin;
+    bool in_digits = false;
+    for(; end - block >= 64; block += 64){
+        auto digits = digit_mask(block);
+        auto starts = digits & ~((digits << 1) | std::uint64_t(in_digits));
+        in_digits = (digits >> 63) != 0;
+        if(starts == 0){
+            continue;
+        }
+        auto size = values.size();
+        values.resize(size + std::size_t(__builtin_popcountll(starts)));
+        auto* out = values.data() + size;
+        while(starts != 0){
+            auto i = std::size_t(__builtin_ctzll(starts));
+            auto const* str = block + i;
+            auto rest = ~digits >> i;
+            auto value = (rest != 0 ? parse_run(str, std::size_t(__builtin_ctzll(rest)), end)
+                                    : parse_digits(str, end));
+            *out++ = sign(block + i, value);
+            starts &= starts - 1;
+        }
+    }
+    for(auto const* str = block; str < end; ++str){
+        auto is_digit = ('0' <= *str && *str <= '9');
+        if(is_digit && !in_digits){
+            auto const* first = str;
+            values.push_back(sign(first, parse_digits(str, end)));
+            --str;
+        }
+        in_digits = is_digit;
+    }
+}
+
+template<typename T>
+inline auto parse_integers(std::string_view text) noexcept{
+    auto values = std::vector<T>{};
+    parse_integers(text, values);
+    return values;
+}
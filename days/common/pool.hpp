@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Work stealing - `count` jobs, numbered in the order they should start, run
+ * on `threads` threads as `f(job, thread)`
+ *
+ * Jobs are dealt round robin onto one deque per thread. A thread takes jobs
+ * from the front of its own deque and, once that runs dry, steals from the
+ * back of the others, so the first jobs start first while the last (and
+ * cheapest) ones fill in wherever a thread is idle
+ * The thread number lets jobs reuse per thread scratch space
+ */
+struct Worker{
+    std::mutex mutex;
+    std::deque<std::size_t> jobs;
+};
+
+inline bool take_job(Worker& worker, std::size_t& job, bool steal) noexcept{
+    auto lock = std::lock_guard{worker.mutex};
+    if(worker.jobs.empty()){
+        return false;
+    }
+    if(steal){
+        job = worker.jobs.back();
+        worker.jobs.pop_back();
+    } else{
+        job = worker.jobs.front();
+        worker.jobs.pop_front();
+    }
+    return true;
+}
+
+inline std::size_t default_threads() noexcept{
+    auto threads = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+template<typename F>
+inline void run_parallel(std::size_t count, std::size_t threads, F&& f){
+    threads = (threads == 0 ? 1 : threads);
+    threads = (threads > count ? count : threads);
+    if(threads <= 1){
+        for(std::size_t job = 0; job < count; ++job){
+            f(job, 0);
+        }
+        return;
+    }
+
+    auto workers = std::vector<Worker>(threads);
+    for(std::size_t job = 0; job < count; ++job){
+        workers[job % threads].jobs.push_back(job);
+    }
+    auto work = [&](std::size_t thread){
+        std::size_t job;
+        while(true){
+            if(take_job(workers[thread], job, false)){
+                f(job, thread);
+                continue;
+            }
+            // Nothing is ever added, so once every deque is empty we are done
+            auto stolen = false;
+            for(std::size_t i = 1; i < threads && !stolen; ++i){
+                stolen = take_job(workers[(thread + i) % threads], job, true);
+            }
+            if(!stolen){
+                return;
+            }
+            f(job, thread);
+        }
+    };
+
+    auto pool = std::vector<std::thread>{};
+    for(std::size_t thread = 1; thread < threads; ++thread){
+        pool.emplace_back(work, thread);
+    }
+    work(0);
+    for(auto& thread : pool){
+        thread.join();
+    }
+}
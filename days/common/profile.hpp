@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#ifdef PROFILE_PHASES
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Phase profiling - a day built with `-DPROFILE_PHASES` times every phase it
+ * runs through `profile(name, f)`, and where perf_event_open is allowed also
+ * counts the cycles, instructions, cache misses and branch misses of it
+ * At exit the phases are printed to stderr as a tree, with instructions per
+ * cycle and misses per thousand instructions, which tell a memory bound phase
+ * (low IPC, many cache misses) from a compute bound one
+ * With PROFILE_TRACE=<file> the time spent in each phase itself is also
+ * written there as folded stacks, the input of flamegraph.pl
+ *
+ * Without the flag `profile(name, f)` is just `f()`
+ * There is one tree for the whole process, so like the allocation accounting
+ * it is meant for a day built on its own, not for the driver
+ */
+#ifdef PROFILE_PHASES
+namespace profiling{
+    constexpr std::size_t counters = 4;
+
+    struct Node{
+        char const* name;
+        std::size_t parent;
+        std::size_t calls;
+        std::uint64_t wall_ns;
+        std::uint64_t counts[counters];
+    };
+
+    struct Counts{
+        std::uint64_t nr;
+        std::uint64_t values[counters];
+    };
+
+    inline std::vector<Node> nodes;
+    inline std::size_t current = 0;
+    inline int group = -1;
+    inline int open_error = 0;
+
+    inline std::uint64_t now_ns() noexcept{
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // One group of user space counters for this thread, read all at once
+    inline void open_counters() noexcept{
+        constexpr static std::uint64_t configs[counters] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        int fds[counters] = {-1, -1, -1, -1};
+        for(std::size_t i = 0; i < counters; ++i){
+            auto attr = perf_event_attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = (i == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+            if(fds[i] < 0){
+                open_error = errno;
+                for(std::size_t j = 0; j < i; ++j){
+                    close(fds[j]);
+                }
+                return;
+            }
+        }
+        group = fds[0];
+        ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    inline void read_counts(std::uint64_t (&values)[counters]) noexcept{
+        auto counts = Counts{};
+        if(group >= 0 && read(group, &counts, sizeof(counts)) == sizeof(counts)){
+            std::memcpy(values, counts.values, sizeof(values));
+        }
+    }
+
+    inline std::size_t child(std::size_t parent, char const* name) noexcept{
+        for(std::size_t i = 1; i < nodes.size(); ++i){
+            if(nodes[i].parent == parent && std::strcmp(nodes[i].name, name) == 0){
+                return i;
+            }
+        }
+        nodes.push_back({name, parent, 0, 0, {}});
+        return nodes.size() - 1;
+    }
+
+    struct Scope{
+        std::size_t node;
+        std::size_t parent;
+        std::uint64_t begin_ns;
+        std::uint64_t begin_counts[counters] = {};
+
+        explicit Scope(char const* name) noexcept : node{child(current, name)}, parent{current}{
+            current = node;
+            read_counts(begin_counts);
+            begin_ns = now_ns();
+        }
+        ~Scope(){
+            auto end_ns = now_ns();
+            std::uint64_t end_counts[counters] = {};
+            read_counts(end_counts);
+            auto& n = nodes[node];
+            ++n.calls;
+            n.wall_ns += end_ns - begin_ns;
+            for(std::size_t i = 0; i < counters; ++i){
+                n.counts[i] += end_counts[i] - begin_counts[i];
+            }
+            current = parent;
+        }
+    };
+
+    template<typename F>
+    inline decltype(auto) measure(char const* name, F&& f){
+        auto scope = Scope{name};
+        return f();
+    }
+
+    /*
+     * Reporting - the root is the whole run, from static initialisation to
+     * exit, so that its own time is whatever no phase covered
+     */
+    inline std::uint64_t self_ns(std::size_t i) noexcept{
+        auto self = nodes[i].wall_ns;
+        for(std::size_t j = 1; j < nodes.size(); ++j){
+            if(nodes[j].parent == i){
+                self -= std::min(self, nodes[j].wall_ns);
+            }
+        }
+        return self;
+    }
+
+    inline void print_tree(std::size_t i, std::size_t depth) noexcept{
+        auto const& n = nodes[i];
+        char label[64];
+        std::snprintf(label, sizeof(label), "%*s%s", int(2 * depth), "", n.name);
+        std::fprintf(stderr, "%-40s %8lu %12.3f", label, n.calls, double(n.wall_ns) / 1e6);
+        if(group >= 0){
+            auto instructions = double(n.counts[1]);
+            auto per_k = (instructions > 0 ? 1000 / instructions : 0);
+            std::fprintf(stderr, " %14lu %14lu %6.2f %12.2f %12.2f", n.counts[0], n.counts[1],
+                n.counts[0] > 0 ? instructions / double(n.counts[0]) : 0, double(n.counts[2]) * per_k, double(n.counts[3]) * per_k);
+        }
+        std::fprintf(stderr, "\n");
+        for(std::size_t j = 1; j < nodes.size(); ++j){
+            if(nodes[j].parent == i){
+                print_tree(j, depth + 1);
+            }
+        }
+    }
+
+    inline std::string stack_of(std::size_t i) noexcept{
+        return i == 0 ? nodes[0].name : stack_of(nodes[i].parent) + ";" + nodes[i].name;
+    }
+
+    inline void report() noexcept{
+        auto& root = nodes[0];
+        root.wall_ns = now_ns() - root.wall_ns;
+        std::uint64_t end_counts[counters] = {};
+        read_counts(end_counts);
+        for(std::size_t i = 0; i < counters; ++i){
+            root.counts[i] = end_counts[i] - root.counts[i];
+        }
+
+        std::fprintf(stderr, "%-40s %8s %12s", "phase", "calls", "wall ms");
+        if(group >= 0){
+            std::fprintf(stderr, " %14s %14s %6s %12s %12s", "cycles", "instructions", "IPC", "cache mpki", "branch mpki");
+        }
+        std::fprintf(stderr, "\n");
+        print_tree(0, 0);
+        if(group < 0){
+            std::fprintf(stderr, "(no hardware counters: %s)\n", std::strerror(open_error));
+        }
+
+        auto const* trace = std::getenv("PROFILE_TRACE");
+        if(!trace){
+            return;
+        }
+        auto* file = std::fopen(trace, "w");
+        if(!file){
+            std::fprintf(stderr, "%s: %s\n", trace, std::strerror(errno));
+            return;
+        }
+        for(std::size_t i = 0; i < nodes.size(); ++i){
+            auto self_us = self_ns(i) / 1000;
+            if(self_us > 0){
+                std::fprintf(file, "%s %lu\n", stack_of(i).c_str(), self_us);
+            }
+        }
+        std::fclose(file);
+    }
+
+    inline bool start() noexcept{
+        open_counters();
+        nodes.push_back({"main", 0, 1, now_ns(), {}});
+        read_counts(nodes[0].counts);
+        std::atexit(report);
+        return true;
+    }
+
+    inline auto const started = start();
+}
+#endif
+
+/*
+ * Run `f()` as the named phase, a string literal
+ * Usable from constexpr code, where it only runs `f()`
+ */
+template<typename F>
+constexpr decltype(auto) profile([[maybe_unused]] char const* name, F&& f){
+#ifdef PROFILE_PHASES
+    if(!__builtin_is_constant_evaluated()){
+        return profiling::measure(name, std::forward<F>(f));
+    }
+#endif
+    return f();
+}
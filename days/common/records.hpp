@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Records separated by blank lines - passports, customs groups... - split
+ * into chunks that can be worked on in parallel
+ *
+ * A blank line, "\n\n", is found 64 characters at a time as the newlines of
+ * a block that also have a newline straight after them
+ * Uses AVX2 or SSE2 when the compiler has been allowed to
+ */
+inline std::uint64_t newline_mask(char const* str) noexcept{
+#if defined(__AVX2__)
+    auto newline = _mm256_set1_epi8('\n');
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 32){
+        auto chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(str + i));
+        mask |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newline)))) << i;
+    }
+    return mask;
+#elif defined(__SSE2__)
+    auto newline = _mm_set1_epi8('\n');
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 16){
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str + i));
+        mask |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline)))) << i;
+    }
+    return mask;
+#else
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; ++i){
+        mask |= std::uint64_t(str[i] == '\n') << i;
+    }
+    return mask;
+#endif
+}
+
+// The first "\n\n" in [str, end), or `end` when there is none
+inline char const* find_record_break(char const* str, char const* end) noexcept{
+    // Each block reads one character past itself, to see the newline after its last
+    for(; end - str > 64; str += 64){
+        auto newlines = newline_mask(str);
+        auto breaks = newlines & ((newlines >> 1) | (std::uint64_t(str[64] == '\n') << 63));
+        if(breaks != 0){
+            return str + __builtin_ctzll(breaks);
+        }
+    }
+    for(; end - str > 1; ++str){
+        if(str[0] == '\n' && str[1] == '\n'){
+            return str;
+        }
+    }
+    return end;
+}
+
+/*
+ * The text cut into chunks of about `chunk_bytes`, each moved on to just
+ * after the next blank line, so that every record lies whole in one chunk
+ * Every chunk but the last ends with the blank line, an empty record
+ */
+inline std::vector<std::string_view> split_records(std::string_view text, std::size_t chunk_bytes) noexcept{
+    auto const* begin = text.data();
+    auto const* end = begin + text.size();
+    auto chunks = std::vector<std::string_view>{};
+    auto const* start = begin;
+    for(auto const* str = begin + chunk_bytes; str < end; str += chunk_bytes){
+        // From one character early, in case the cut is between the two newlines
+        auto const* at = find_record_break(str - 1 > start ? str - 1 : start, end);
+        if(at == end){
+            break;
+        }
+        chunks.emplace_back(start, std::size_t(at + 2 - start));
+        start = str = at + 2;
+    }
+    chunks.emplace_back(start, std::size_t(end - start));
+    return chunks;
+}
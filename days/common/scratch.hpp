@@ -0,0 +1,19 @@
+#pragma once
+
+#include <memory>
+
+/*
+ * Scratch space - one object of type T per thread (and per Tag), kept alive
+ * between calls so that large tables are allocated once per thread rather
+ * than once per input
+ *
+ * The object itself lives on the heap, so that a large one does not end up
+ * in the thread local storage of every thread
+ * Whoever takes it is expected to reset it, as it holds whatever the last
+ * user on this thread left behind
+ */
+template<typename T, typename Tag = void>
+inline T& scratch() noexcept{
+    thread_local auto value = std::make_unique<T>();
+    return *value;
+}
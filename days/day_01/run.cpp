@@ -1,76 +1,459 @@
+#include <chrono>
 #include <cstdio>
+#include <cstdint>
+#include <array>
 #include <tuple>
+#include <utility>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
 
-// One entry
+/*
+ * Any number of entries summing to any target
+ *
+ * The entries are searched through a copy of their indices sorted by value,
+ * so a search never needs more than that and one pass per entry fixed:
+ *   - two entries meet from both ends of the sorted order
+ *   - three fix the lowest entry and meet the other two from both ends
+ *   - four or more look the lowest two up in a table of every pair sum,
+ *     sorted, so the rest is only k - 2 entries deep
+ * Each level stops as soon as the entries left are too small or too large
+ * to reach what is left of the target
+ */
+constexpr std::size_t max_k = 8;
 
-template<auto target, auto x, auto... xs>
-constexpr auto calculate_one_impl() noexcept{
-    if constexpr(sizeof...(xs) > 0){
-        if constexpr(target == x){
-            return x;
-        } else{
-            return calculate_one_impl<target, xs...>();
+struct Sum{
+    bool found = false;
+    std::int64_t product = -1;
+    std::size_t k = 0;
+    std::array<std::size_t, max_k> indices = {};
+};
+
+struct Pair{
+    std::int64_t sum;
+    std::size_t low;
+    std::size_t high;
+};
+
+constexpr bool operator<(Pair const& lhs, Pair const& rhs) noexcept{
+    return lhs.sum < rhs.sum || (lhs.sum == rhs.sum && lhs.high < rhs.high);
+}
+
+template<typename T>
+constexpr void swap(T& lhs, T& rhs) noexcept{
+    auto tmp = lhs;
+    lhs = rhs;
+    rhs = tmp;
+}
+
+// Heap sort, in place and without recursion, so it is as cheap for the
+// compiler as it is at runtime
+template<typename Array, typename Less>
+constexpr void sift_down(Array& array, std::size_t root, std::size_t size, Less const& less) noexcept{
+    while(2 * root + 1 < size){
+        auto child = 2 * root + 1;
+        if(child + 1 < size && less(array[child], array[child + 1])){
+            ++child;
         }
-    } else{
-        return -1;
+        if(!less(array[root], array[child])){
+            return;
+        }
+        swap(array[root], array[child]);
+        root = child;
     }
 }
 
-// Two entries
-
-template<auto target, auto x, auto... xs>
-constexpr auto calculate_two_impl() noexcept{
-    if constexpr(sizeof...(xs) > 0){
-        if constexpr(target - x < 0){
-            return calculate_two_impl<target, xs...>();
-        } else{
-            constexpr auto result = calculate_one_impl<target - x, xs...>();
-            if(result >= 0){
-                return result * x;
+template<typename Array, typename Less>
+constexpr void heap_sort(Array& array, std::size_t size, Less const& less) noexcept{
+    for(std::size_t i = size / 2; i > 0; --i){
+        sift_down(array, i - 1, size, less);
+    }
+    for(std::size_t end = size; end > 1; --end){
+        swap(array[0], array[end - 1]);
+        sift_down(array, 0, end - 1, less);
+    }
+}
+
+template<typename Array>
+struct Search{
+    Array const& array;
+    std::size_t const* order;
+    std::size_t size;
+    Pair const* pairs;
+    std::size_t no_of_pairs;
+    std::size_t k;
+    std::size_t chosen[max_k];
+
+    constexpr std::int64_t value(std::size_t position) const noexcept{
+        return std::int64_t(array[order[position]]);
+    }
+
+    constexpr Sum result() const noexcept{
+        auto sum = Sum{true, 1, k, {}};
+        for(std::size_t i = 0; i < k; ++i){
+            sum.indices[i] = order[chosen[i]];
+            sum.product *= value(chosen[i]);
+        }
+        return sum;
+    }
+
+    // One entry from [begin, size), by bisection
+    constexpr bool one(std::size_t depth, std::size_t begin, std::int64_t target) noexcept{
+        auto low = begin;
+        auto high = size;
+        while(low < high){
+            auto middle = low + (high - low) / 2;
+            if(value(middle) < target){
+                low = middle + 1;
             } else{
-                return calculate_two_impl<target, xs...>();
+                high = middle;
             }
         }
-    } else{
-        return -1;
+        if(low == size || value(low) != target){
+            return false;
+        }
+        chosen[depth] = low;
+        return true;
+    }
+
+    // Two entries from [begin, size), from both ends
+    constexpr bool two(std::size_t begin, std::int64_t target) noexcept{
+        if(size - begin < 2){
+            return false;
+        }
+        auto low = begin;
+        auto high = size - 1;
+        while(low < high){
+            auto sum = value(low) + value(high);
+            if(sum == target){
+                chosen[k - 2] = low;
+                chosen[k - 1] = high;
+                return true;
+            }
+            if(sum < target){
+                ++low;
+            } else{
+                --high;
+            }
+        }
+        return false;
+    }
+
+    // The lowest pair below `upper`, from the table
+    constexpr bool lookup(std::size_t upper, std::int64_t target) noexcept{
+        std::size_t low = 0;
+        std::size_t high = no_of_pairs;
+        while(low < high){
+            auto middle = low + (high - low) / 2;
+            if(pairs[middle].sum < target){
+                low = middle + 1;
+            } else{
+                high = middle;
+            }
+        }
+        if(low == no_of_pairs || pairs[low].sum != target || pairs[low].high >= upper){
+            return false;
+        }
+        chosen[0] = pairs[low].low;
+        chosen[1] = pairs[low].high;
+        return true;
+    }
+
+    // Entry `depth` onwards from [begin, size), `left` of them
+    constexpr bool search(std::size_t depth, std::size_t begin, std::int64_t target) noexcept{
+        auto left = k - depth;
+        if(left == 0){
+            return target == 0;
+        }
+        if(left == 1){
+            return one(depth, begin, target);
+        }
+        if(left == 2){
+            return two(begin, target);
+        }
+        if(size - begin < left){
+            return false;
+        }
+        auto highest = value(size - 1);
+        for(auto i = begin; i + left <= size; ++i){
+            auto x = value(i);
+            if(x * std::int64_t(left) > target){
+                break;
+            }
+            if(x + highest * std::int64_t(left - 1) < target){
+                continue;
+            }
+            chosen[depth] = i;
+            if(search(depth + 1, i + 1, target - x)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Everything but the lowest pair, which comes from the table
+    constexpr bool upper(std::size_t depth, std::size_t begin, std::int64_t target) noexcept{
+        if(depth == k){
+            return lookup(chosen[2], target);
+        }
+        auto left = std::int64_t(k - depth);
+        auto lowest_pair = value(0) + value(1);
+        auto highest = value(size - 1);
+        for(auto i = begin; i + (k - depth) <= size; ++i){
+            auto x = value(i);
+            if(x * left + lowest_pair > target){
+                break;
+            }
+            if(x + highest * (left - 1) + pairs[no_of_pairs - 1].sum < target){
+                continue;
+            }
+            chosen[depth] = i;
+            if(upper(depth + 1, i + 1, target - x)){
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template<typename Array, typename Order, typename Pairs>
+constexpr Sum find_sum_impl(Array const& array, std::size_t k, std::int64_t target, Order& order, Pairs& pairs) noexcept{
+    auto size = std::size_t(array.size());
+    if(k > max_k || k > size){
+        return Sum{};
+    }
+    for(std::size_t i = 0; i < size; ++i){
+        order[i] = i;
+    }
+    heap_sort(order, size, [&](std::size_t lhs, std::size_t rhs){ return array[lhs] < array[rhs]; });
+
+    auto search = Search<Array>{array, order.data(), size, nullptr, 0, k, {}};
+    if(k >= 4){
+        std::size_t no_of_pairs = 0;
+        for(std::size_t high = 1; high < size; ++high){
+            for(std::size_t low = 0; low < high; ++low){
+                pairs[no_of_pairs++] = Pair{search.value(low) + search.value(high), low, high};
+            }
+        }
+        heap_sort(pairs, no_of_pairs, [](Pair const& lhs, Pair const& rhs){ return lhs < rhs; });
+        search.pairs = pairs.data();
+        search.no_of_pairs = no_of_pairs;
+        if(search.upper(2, 2, target)){
+            return search.result();
+        }
+        return Sum{};
+    }
+    if(search.search(0, 0, target)){
+        return search.result();
     }
+    return Sum{};
 }
 
-template<auto... xs>
-constexpr auto calculate_two() noexcept{
-    return calculate_two_impl<2020, xs...>();
+template<std::size_t k, typename T, std::size_t size>
+constexpr Sum find_sum(std::array<T, size> const& array, std::int64_t target) noexcept{
+    auto order = std::array<std::size_t, size>{};
+    auto pairs = std::array<Pair, k >= 4 ? size * (size - 1) / 2 : 1>{};
+    return find_sum_impl(array, k, target, order, pairs);
 }
 
-// Three entries
-
-template<auto target, auto x, auto... xs>
-constexpr auto calculate_three_impl() noexcept{
-    if constexpr(sizeof...(xs) > 0){
-        if constexpr(target - x < 0){
-            return calculate_three_impl<target, xs...>();
-        } else{
-            constexpr auto result = calculate_two_impl<target - x, xs...>();
-            if(result >= 0){
-                return result * x;
-            } else{
-                return calculate_three_impl<target, xs...>();
+// The same, but with the number of entries only known at runtime
+
+template<typename T>
+inline Sum find_sum(std::vector<T> const& array, std::size_t k, std::int64_t target) noexcept{
+    auto order = std::vector<std::size_t>(array.size());
+    auto pairs = std::vector<Pair>(k >= 4 ? array.size() * (array.size() - 1) / 2 : 0);
+    return find_sum_impl(array, k, target, order, pairs);
+}
+
+template<std::size_t k, typename T>
+inline Sum find_sum(std::vector<T> const& array, std::int64_t target) noexcept{
+    return find_sum(array, k, target);
+}
+
+// Two and three entries, the product of them or -1 if there are none
+
+template<typename Array>
+constexpr std::int64_t calculate_two(Array const& array, std::int64_t target = 2020) noexcept{
+    return find_sum<2>(array, target).product;
+}
+
+template<typename Array>
+constexpr std::int64_t calculate_three(Array const& array, std::int64_t target = 2020) noexcept{
+    return find_sum<3>(array, target).product;
+}
+
+/*
+ * Many targets over the same entries
+ *
+ * The index sorts the entries once and, when their range is small enough,
+ * keeps a bitset of the values present and, for every pair sum, the pair
+ * with the lowest upper entry, so that a query only walks the entries once:
+ *   - one entry is a bit
+ *   - two entries look up what is left of the target for each entry
+ *   - three look up what is left for each entry in the pair sums below it,
+ *     and more fix the highest k - 3 entries before doing the same
+ * Entries too spread out to index go to find_sum
+ * Every answer is the product of the entries or -1, as calculate_two and
+ * calculate_three give
+ */
+constexpr std::int64_t max_indexed_range = std::int64_t(1) << 20;
+
+struct Index{
+    std::vector<std::int32_t> entries;
+    std::vector<std::int32_t> values;
+    std::int64_t lowest = 0;
+    std::int64_t range = 0;
+    std::vector<std::uint64_t> present;
+    std::vector<std::uint32_t> pair_high;
+    std::vector<std::uint32_t> pair_low;
+
+    bool dense() const noexcept{
+        return !present.empty();
+    }
+
+    bool contains(std::int64_t value) const noexcept{
+        auto offset = value - lowest;
+        if(offset < 0 || offset >= range){
+            return false;
+        }
+        return (present[std::size_t(offset) / 64] >> (std::size_t(offset) % 64)) & 1;
+    }
+
+    std::int64_t one(std::int64_t target) const noexcept{
+        return contains(target) ? target : -1;
+    }
+
+    std::int64_t two(std::int64_t target) const noexcept{
+        for(std::size_t i = 0; i < values.size() && 2 * std::int64_t(values[i]) <= target; ++i){
+            auto x = std::int64_t(values[i]);
+            auto y = target - x;
+            if(y == x ? i + 1 < values.size() && values[i + 1] == values[i] : contains(y)){
+                return x * y;
             }
         }
-    } else{
         return -1;
     }
+
+    // The highest `left` entries below `end`, the lowest two of them a pair
+    std::int64_t many(std::size_t left, std::size_t end, std::int64_t target, std::int64_t product) const noexcept{
+        if(left == 2){
+            auto offset = target - 2 * lowest;
+            if(offset < 0 || offset >= std::int64_t(pair_high.size())){
+                return -1;
+            }
+            auto high = pair_high[std::size_t(offset)];
+            if(high == 0 || high > end){
+                return -1;
+            }
+            return product * values[high - 1] * values[pair_low[std::size_t(offset)]];
+        }
+        for(auto i = end; i-- > left - 1;){
+            auto x = std::int64_t(values[i]);
+            if(x * std::int64_t(left) < target){
+                break;
+            }
+            if(x + lowest * std::int64_t(left - 1) > target){
+                continue;
+            }
+            // The same value one higher up has already tried everything below
+            if(i + 1 < end && values[i + 1] == values[i]){
+                continue;
+            }
+            auto result = many(left - 1, i, target - x, product * x);
+            if(result != -1){
+                return result;
+            }
+        }
+        return -1;
+    }
+
+    std::int64_t query(std::size_t k, std::int64_t target) const noexcept{
+        if(!dense() || k == 0 || k > values.size()){
+            return find_sum(entries, k, target).product;
+        }
+        switch(k){
+            case 1: return one(target);
+            case 2: return two(target);
+            default: return many(k, values.size(), target, 1);
+        }
+    }
+};
+
+inline Index build_index(std::vector<std::int32_t> entries) noexcept{
+    auto index = Index{};
+    index.values = entries;
+    index.entries = std::move(entries);
+    auto& values = index.values;
+    if(values.empty()){
+        return index;
+    }
+    heap_sort(values, values.size(), [](std::int32_t lhs, std::int32_t rhs){ return lhs < rhs; });
+    index.lowest = values.front();
+    index.range = std::int64_t(values.back()) - index.lowest + 1;
+    if(index.range > max_indexed_range || values.size() > std::size_t(UINT32_MAX)){
+        return index;
+    }
+    index.present.resize((std::size_t(index.range) + 63) / 64);
+    for(auto value : values){
+        auto offset = std::size_t(value - index.lowest);
+        index.present[offset / 64] |= std::uint64_t(1) << (offset % 64);
+    }
+    index.pair_high.resize(2 * std::size_t(index.range) - 1);
+    index.pair_low.resize(index.pair_high.size());
+    for(std::size_t high = 1; high < values.size(); ++high){
+        for(std::size_t low = 0; low < high; ++low){
+            auto offset = std::size_t(std::int64_t(values[low]) + values[high] - 2 * index.lowest);
+            if(index.pair_high[offset] == 0){
+                index.pair_high[offset] = std::uint32_t(high + 1);
+                index.pair_low[offset] = std::uint32_t(low);
+            }
+        }
+    }
+    return index;
 }
 
-template<auto... xs>
-constexpr auto calculate_three() noexcept{
-    return calculate_three_impl<2020, xs...>();
+/*
+ * Query mode - `./run <input> <queries>` answers every `k target` line of
+ * the queries file against one index, printing the answers in order and the
+ * query throughput to stderr
+ */
+inline int run_queries(std::vector<std::int32_t> entries, char const* path) noexcept{
+    auto queries_file = map_input(path);
+    if(!queries_file){
+        return 1;
+    }
+    auto numbers = profile("parse_queries", [&]{ return parse_integers<std::int64_t>(queries_file->text()); });
+    auto no_of_queries = numbers.size() / 2;
+    auto start = std::chrono::steady_clock::now();
+    auto index = profile("build_index", [&]{ return build_index(std::move(entries)); });
+    auto built = std::chrono::steady_clock::now();
+    auto answers = profile("query", [&]{
+        auto answers = std::vector<std::int64_t>(no_of_queries);
+        for(std::size_t i = 0; i < no_of_queries; ++i){
+            auto k = numbers[2 * i];
+            answers[i] = (k < 0 ? -1 : index.query(std::size_t(k), numbers[2 * i + 1]));
+        }
+        return answers;
+    });
+    auto done = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < no_of_queries; ++i){
+        std::printf("%ld %ld = %ld\n", numbers[2 * i], numbers[2 * i + 1], answers[i]);
+    }
+    auto build_ms = std::chrono::duration<double, std::milli>(built - start).count();
+    auto query_ms = std::chrono::duration<double, std::milli>(done - built).count();
+    std::fprintf(stderr, "index of %lu entries built in %.3f ms (%s), %lu queries in %.3f ms, %.0f queries/s\n",
+        index.values.size(), build_ms, index.dense() ? "dense" : "sparse", no_of_queries, query_ms,
+        query_ms > 0 ? double(no_of_queries) / query_ms * 1000 : 0.0);
+    return 0;
 }
 
 // Altogether
 
 template<auto... xs>
 constexpr auto calculate() noexcept{
-    return std::make_tuple(calculate_two<xs...>(), calculate_three<xs...>());
+    constexpr auto entries = std::array<std::int32_t, sizeof...(xs)>{xs...};
+    return std::make_tuple(calculate_two(entries), calculate_three(entries));
 }
 
 constexpr static auto result = calculate<
@@ -276,7 +659,21 @@ constexpr static auto result = calculate<
     1570
 >();
 
-int main(){
-    std::printf("Two entries = %d | Three entries = %d\n", std::get<0>(result), std::get<1>(result));
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto entries = profile("parse_integers", [&]{ return parse_integers<std::int32_t>(input->text()); });
+        if(argc > 2){
+            return run_queries(std::move(entries), argv[2]);
+        }
+        auto two = profile("calculate_two", [&]{ return calculate_two(entries); });
+        auto three = profile("calculate_three", [&]{ return calculate_three(entries); });
+        std::printf("Two entries = %ld | Three entries = %ld\n", two, three);
+        return 0;
+    }
+    std::printf("Two entries = %ld | Three entries = %ld\n", std::get<0>(result), std::get<1>(result));
     return 0;
 }
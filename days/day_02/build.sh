@@ -1 +1 @@
-g++ -O3 -std=c++17 -ftemplate-depth=1100 -o run run.cpp
+g++ -O3 -std=c++17 -ftemplate-depth=1100 -pthread -o run run.cpp
@@ -1,23 +1,24 @@
+#include <cerrno>
 #include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <array>
 #include <experimental/array>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/pool.hpp"
+#include "../common/profile.hpp"
+#include "../common/scratch.hpp"
+#include "../common/evaluate.hpp"
 
-constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
-    std::int32_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            *endptr = str;
-            return i;
-        }
-    }
-    *endptr = str;
-    return i;
-}
-
-template<auto f>
-constexpr auto valid_password(char const* str) noexcept{
+// Every policy for one line, parsing it once
+template<auto... fs>
+constexpr auto valid_policies(char const* str) noexcept{
     auto x = str_to_int(str, &str);
     ++str;
     auto y = str_to_int(str, &str);
@@ -25,11 +26,16 @@ constexpr auto valid_password(char const* str) noexcept{
     auto l = *str;
     ++str;
     ++str;
-    return f(x, y, l, str);
+    return std::array<bool, sizeof...(fs)>{fs(x, y, l, str)...};
 }
 
-template<auto f, std::size_t size>
-constexpr auto valid(std::array<char const*, size> const& strs) noexcept{
+template<auto f>
+constexpr auto valid_password(char const* str) noexcept{
+    return valid_policies<f>(str)[0];
+}
+
+template<auto f, typename Array>
+constexpr auto valid(Array const& strs) noexcept{
     std::size_t n = 0;
     for(auto const& str : strs){
         n += int(valid_password<f>(str));
@@ -50,8 +56,265 @@ constexpr auto original(std::int32_t x, std::int32_t y, char l, char const* str)
 
 // Official policy
 
+// A position past the end of the password never holds the letter
 constexpr auto official(std::int32_t x, std::int32_t y, char l, char const* str) noexcept{
-    return (str[x] == l) != (str[y] == l);
+    auto at = [&](std::int32_t i){
+        for(std::int32_t j = 1; j < i; ++j){
+            if(str[j] == '\0'){
+                return false;
+            }
+        }
+        return str[i] == l;
+    };
+    return at(x) != at(y);
+}
+
+/*
+ * Runtime validation - a block of lines at a time, first parsing every
+ * policy in the block into arrays of their own, then counting each letter
+ * with SIMD compares, so both policies come out of one pass over the text
+ */
+constexpr std::size_t block_lines = 256;
+
+struct Policies{
+    std::uint32_t x[block_lines];
+    std::uint32_t y[block_lines];
+    char letter[block_lines];
+    char const* password[block_lines];
+    std::uint32_t length[block_lines];
+    std::size_t size;
+};
+
+/*
+ * The policies of up to `block_lines` lines from `str`, returning where the
+ * next block starts
+ * Blank lines are skipped, and a line cut short ends the text
+ */
+inline char const* parse_policies(char const* str, char const* end, Policies& policies) noexcept{
+    policies.size = 0;
+    while(str < end && policies.size < block_lines){
+        if(*str == '\n' || *str == '\r'){
+            ++str;
+            continue;
+        }
+        auto x = parse_digits(str, end);
+        ++str;
+        auto y = parse_digits(str, end);
+        ++str;
+        if(end - str < 3){
+            return end;
+        }
+        auto l = *str;
+        str += 3;
+        auto const* newline = static_cast<char const*>(std::memchr(str, '\n', std::size_t(end - str)));
+        auto const* last = (newline ? newline : end);
+        auto const* next = (newline ? newline + 1 : end);
+        if(last > str && *(last - 1) == '\r'){
+            --last;
+        }
+        auto i = policies.size++;
+        policies.x[i] = std::uint32_t(x);
+        policies.y[i] = std::uint32_t(y);
+        policies.letter[i] = l;
+        policies.password[i] = str;
+        policies.length[i] = std::uint32_t(last - str);
+        str = next;
+    }
+    return str;
+}
+
+/*
+ * How many of the `n` characters at `str` are `l`, with AVX2 or SSE2 when
+ * the compiler has been allowed to, as long as the loads stay before `end`
+ */
+inline std::size_t count_letter(char const* str, std::size_t n, char l, char const* end) noexcept{
+    std::size_t count = 0;
+#if defined(__AVX2__)
+    auto letter = _mm256_set1_epi8(l);
+    for(; n > 0 && end - str >= 32; str += 32){
+        auto chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(str));
+        auto mask = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, letter)));
+        if(n < 32){
+            mask &= (std::uint32_t(1) << n) - 1;
+        }
+        count += std::size_t(__builtin_popcount(mask));
+        n -= (n < 32 ? n : 32);
+    }
+#elif defined(__SSE2__)
+    auto letter = _mm_set1_epi8(l);
+    for(; n > 0 && end - str >= 16; str += 16){
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str));
+        auto mask = std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, letter)));
+        if(n < 16){
+            mask &= (std::uint32_t(1) << n) - 1;
+        }
+        count += std::size_t(__builtin_popcount(mask));
+        n -= (n < 16 ? n : 16);
+    }
+#endif
+    for(; n > 0; --n, ++str){
+        count += std::size_t(*str == l);
+    }
+    return count;
+}
+
+// Both policies, with a position past the password never holding the letter
+inline auto validate(std::string_view text) noexcept{
+    auto policies = Policies{};
+    auto counts = std::array<std::size_t, 2>{};
+    auto const* end = text.data() + text.size();
+    for(auto const* str = text.data(); str < end;){
+        str = parse_policies(str, end, policies);
+        for(std::size_t i = 0; i < policies.size; ++i){
+            auto x = policies.x[i];
+            auto y = policies.y[i];
+            auto l = policies.letter[i];
+            auto const* password = policies.password[i];
+            auto length = policies.length[i];
+            auto n = count_letter(password, length, l, end);
+            auto at_x = (x - 1 < length && password[x - 1] == l);
+            auto at_y = (y - 1 < length && password[y - 1] == l);
+            counts[0] += std::size_t(x <= n && n <= y);
+            counts[1] += std::size_t(at_x != at_y);
+        }
+    }
+    return counts;
+}
+
+/*
+ * Streaming - the file read in blocks of `stream_block` bytes by `threads`
+ * threads at once, each block with a buffer of its thread's own, so memory
+ * stays bounded however large the file is
+ *
+ * A block holds the lines starting inside it, reading on past its end to
+ * finish the last of them, and counts the lines valid under each of the
+ * given policies, any of the `(x, y, l, str)` functions `valid` takes
+ * The counts of each thread are added up at the end
+ */
+constexpr std::size_t stream_block = std::size_t(1) << 24;
+
+struct StreamBuffer{};
+
+template<std::size_t policies>
+struct alignas(64) StreamCounts{
+    std::array<std::size_t, policies> n = {};
+};
+
+// Everything from `offset` up to `end` of the file, stopping short at its end
+inline bool read_range(int fd, std::vector<char>& buffer, std::size_t offset, std::size_t end) noexcept{
+    buffer.resize(end - offset);
+    std::size_t done = 0;
+    while(done < buffer.size()){
+        auto n = pread(fd, buffer.data() + done, buffer.size() - done, off_t(offset + done));
+        if(n < 0){
+            return false;
+        }
+        if(n == 0){
+            break;
+        }
+        done += std::size_t(n);
+    }
+    buffer.resize(done);
+    return true;
+}
+
+template<auto... fs>
+inline void stream_block_of(int fd, std::size_t size, std::size_t block, StreamCounts<sizeof...(fs)>& counts, int& error) noexcept{
+    auto begin = block * stream_block;
+    auto end = std::min(size, begin + stream_block);
+    // From one byte early, to tell whether a line starts right at `begin`
+    auto from = (block == 0 ? begin : begin - 1);
+    auto& buffer = scratch<std::vector<char>, StreamBuffer>();
+    // errno is per thread, so it is kept here for the caller to report
+    if(!read_range(fd, buffer, from, end)){
+        error = errno;
+        return;
+    }
+    auto extra = std::vector<char>{};
+    // The file may have shrunk since it was measured, leaving nothing read
+    for(auto offset = end; offset < size && !buffer.empty() && buffer.back() != '\n'; offset += extra.size()){
+        if(!read_range(fd, extra, offset, std::min(size, offset + 4096))){
+            error = errno;
+            return;
+        }
+        if(extra.empty()){
+            break;
+        }
+        auto const* newline = static_cast<char const*>(std::memchr(extra.data(), '\n', extra.size()));
+        auto keep = (newline ? std::size_t(newline - extra.data()) + 1 : extra.size());
+        buffer.insert(buffer.end(), extra.data(), extra.data() + keep);
+        if(newline){
+            break;
+        }
+    }
+    buffer.push_back('\0');
+
+    auto* str = buffer.data();
+    auto* last = buffer.data() + buffer.size() - 1;
+    auto* limit = buffer.data() + (end - from);
+    if(block > 0){
+        str = static_cast<char*>(std::memchr(str, '\n', std::size_t(last - str)));
+        if(!str){
+            return;
+        }
+        ++str;
+    }
+    while(str < limit && str < last){
+        auto* newline = static_cast<char*>(std::memchr(str, '\n', std::size_t(last - str)));
+        auto* next = (newline ? newline + 1 : last);
+        auto* line_end = (newline ? newline : last);
+        if(line_end > str && *(line_end - 1) == '\r'){
+            --line_end;
+        }
+        *line_end = '\0';
+        if(line_end > str){
+            auto valid = valid_policies<fs...>(str);
+            for(std::size_t i = 0; i < valid.size(); ++i){
+                counts.n[i] += std::size_t(valid[i]);
+            }
+        }
+        str = next;
+    }
+}
+
+template<auto... fs>
+inline auto stream_valid(char const* path, std::size_t threads) noexcept{
+    auto result = std::optional<std::array<std::size_t, sizeof...(fs)>>{};
+    auto fd = open(path, O_RDONLY);
+    if(fd < 0){
+        std::perror(path);
+        return result;
+    }
+    struct stat info{};
+    if(fstat(fd, &info) != 0){
+        std::perror(path);
+        close(fd);
+        return result;
+    }
+    auto size = std::size_t(info.st_size);
+    auto blocks = (size + stream_block - 1) / stream_block;
+    threads = std::min(threads == 0 ? default_threads() : threads, std::max<std::size_t>(blocks, 1));
+    auto counts = std::vector<StreamCounts<sizeof...(fs)>>(threads);
+    auto errors = std::vector<int>(threads);
+    run_parallel(blocks, threads, [&](std::size_t block, std::size_t thread){
+        auto error = 0;
+        stream_block_of<fs...>(fd, size, block, counts[thread], error);
+        errors[thread] = (errors[thread] != 0 ? errors[thread] : error);
+    });
+    close(fd);
+    for(auto error : errors){
+        if(error != 0){
+            std::fprintf(stderr, "%s: %s\n", path, std::strerror(error));
+            return result;
+        }
+    }
+    result.emplace();
+    for(auto const& thread_counts : counts){
+        for(std::size_t i = 0; i < sizeof...(fs); ++i){
+            (*result)[i] += thread_counts.n[i];
+        }
+    }
+    return result;
 }
 
 // Altogether
@@ -1059,10 +1322,30 @@ constexpr static auto input = std::experimental::make_array(
     "3-7 g: gdgtnfggq"
 );
 
-constexpr static auto result_old = valid<original>(input);
-constexpr static auto result_new = valid<official>(input);
+constexpr static auto valid_originally = [](auto const& array){ return valid<original>(array); };
+constexpr static auto valid_officially = [](auto const& array){ return valid<official>(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 2){
+        auto threads = std::size_t(std::strtoul(argv[2], nullptr, 10));
+        auto counts = profile("stream_valid", [&]{ return stream_valid<original, official>(argv[1], threads); });
+        if(!counts){
+            return 1;
+        }
+        std::printf("Originally valid = %lu | Officially valid = %lu\n", (*counts)[0], (*counts)[1]);
+        return 0;
+    }
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto [old_valid, new_valid] = profile("validate", [&]{ return validate(input->text()); });
+        std::printf("Originally valid = %lu | Officially valid = %lu\n", old_valid, new_valid);
+        return 0;
+    }
+    auto const& result_old = evaluate<input, valid_originally>();
+    auto const& result_new = evaluate<input, valid_officially>();
     std::printf("Originally valid = %lu | Officially valid = %lu\n", result_old, result_new);
     return 0;
 }
@@ -1,5 +1,22 @@
+#include <chrono>
 #include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <array>
 #include <experimental/array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/pool.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
@@ -20,22 +37,323 @@ constexpr auto make_grid(T&& value, Ts&&... values) noexcept{
     return Grid<T, 1 + sizeof...(Ts)>{std::experimental::make_array(std::forward<T>(value), std::forward<Ts>(values)...)};
 }
 
-// Count trees
+/*
+ * Bit-packed grid - one bit per square, set for a tree, with every row
+ * taking whole 64 bit words, so a row of up to 64 squares is a single word
+ */
+template<typename Words>
+struct PackedGrid{
+    std::size_t no_of_rows;
+    std::size_t no_of_cols;
+    std::size_t words_per_row;
 
-template<auto right, auto down, typename G>
-constexpr auto count_trees(G const& grid) noexcept{
-    std::size_t i = 0;
-    std::size_t j = 0;
-    std::size_t n = 0;
-    while(true){
-        i += down;
-        if(i >= grid.no_of_rows){
-            break;
+    Words words;
+
+    constexpr bool tree(std::size_t i, std::size_t j) const noexcept{
+        return (words[i * words_per_row + j / 64] >> (j % 64)) & 1;
+    }
+};
+
+template<typename G, typename Words>
+constexpr auto pack_grid_impl(G const& grid, Words words) noexcept{
+    auto words_per_row = (grid.no_of_cols + 63) / 64;
+    for(std::size_t i = 0; i < grid.no_of_rows; ++i){
+        auto const* row = grid.array[i];
+        for(std::size_t w = 0; w < words_per_row; ++w){
+            auto end = (64 * w + 64 < grid.no_of_cols ? 64 * w + 64 : grid.no_of_cols);
+            std::uint64_t word = 0;
+            for(std::size_t j = 64 * w; j < end; ++j){
+                word |= std::uint64_t(row[j] == '#') << (j % 64);
+            }
+            words[i * words_per_row + w] = word;
+        }
+    }
+    return PackedGrid<Words>{grid.no_of_rows, grid.no_of_cols, words_per_row, words};
+}
+
+template<std::size_t size_0, std::size_t size_1>
+constexpr auto pack_grid(Grid<CharConstPtr<size_0>, size_1> const& grid) noexcept{
+    constexpr auto words_per_row = (Grid<CharConstPtr<size_0>, size_1>::no_of_cols + 63) / 64;
+    return pack_grid_impl(grid, std::array<std::uint64_t, size_1 * words_per_row>{});
+}
+
+/*
+ * Trees among the 64 characters at `str`, bit `i` for `str[i]`
+ * Uses AVX2 or SSE2 when the compiler has been allowed to
+ */
+inline std::uint64_t tree_mask(char const* str) noexcept{
+#if defined(__AVX2__)
+    auto tree = _mm256_set1_epi8('#');
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 32){
+        auto chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(str + i));
+        mask |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, tree)))) << i;
+    }
+    return mask;
+#elif defined(__SSE2__)
+    auto tree = _mm_set1_epi8('#');
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; i += 16){
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str + i));
+        mask |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, tree)))) << i;
+    }
+    return mask;
+#else
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; ++i){
+        mask |= std::uint64_t(str[i] == '#') << i;
+    }
+    return mask;
+#endif
+}
+
+/*
+ * A grid read at runtime, packed straight from the text of the input in
+ * one pass, without indexing its lines first
+ * Every row is as wide as the first, and 64 characters are compared at a
+ * time while that stays inside the text
+ */
+inline auto pack_grid(std::string_view text) noexcept{
+    auto const* str = text.data();
+    auto const* end = str + text.size();
+    auto const* first = static_cast<char const*>(std::memchr(str, '\n', text.size()));
+    auto no_of_cols = std::size_t((first ? first : end) - str);
+    if(no_of_cols > 0 && str[no_of_cols - 1] == '\r'){
+        --no_of_cols;
+    }
+    auto words_per_row = (no_of_cols + 63) / 64;
+    auto words = std::vector<std::uint64_t>{};
+    words.reserve(words_per_row * (text.size() / (no_of_cols + 1) + 1));
+    std::size_t no_of_rows = 0;
+    while(str < end){
+        auto const* newline = static_cast<char const*>(std::memchr(str, '\n', std::size_t(end - str)));
+        auto const* next = (newline ? newline + 1 : end);
+        auto length = std::size_t((newline ? newline : end) - str);
+        length = (length < no_of_cols ? length : no_of_cols);
+        for(std::size_t w = 0; w < words_per_row; ++w){
+            auto const* chunk = str + 64 * w;
+            auto n = (64 * w < length ? length - 64 * w : 0);
+            n = (n < 64 ? n : 64);
+            std::uint64_t word = 0;
+            if(end - chunk >= 64){
+                word = tree_mask(chunk) & (n == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1);
+            } else{
+                for(std::size_t j = 0; j < n; ++j){
+                    word |= std::uint64_t(chunk[j] == '#') << j;
+                }
+            }
+            words.push_back(word);
+        }
+        ++no_of_rows;
+        str = next;
+    }
+    return PackedGrid<std::vector<std::uint64_t>>{no_of_rows, no_of_cols, words_per_row, std::move(words)};
+}
+
+/*
+ * Count trees - every slope at once, in one sweep down the rows
+ *
+ * Each slope keeps the next row it lands on and its column there, which
+ * wraps around by taking the width off rather than by a `%` per row
+ * The top left square is where every slope starts, so it is never counted
+ */
+struct Slope{
+    std::size_t right;
+    std::size_t down;
+};
+
+/*
+ * Only the rows in [begin, end), each slope starting on the first of them
+ * it lands on, whose column is known directly as (row / down * right) % cols
+ */
+template<typename P, typename Slopes>
+constexpr auto count_slopes(P const& grid, Slopes const& slopes, std::size_t begin, std::size_t end) noexcept{
+    auto counts = storage_for<std::size_t>(slopes);
+    auto rows = storage_for<std::size_t>(slopes);
+    auto cols = storage_for<std::size_t>(slopes);
+    auto steps = storage_for<std::size_t>(slopes);
+    if(grid.no_of_cols == 0){
+        return counts;
+    }
+    for(std::size_t s = 0; s < slopes.size(); ++s){
+        auto down = slopes[s].down;
+        steps[s] = slopes[s].right % grid.no_of_cols;
+        if(down == 0){
+            rows[s] = end;
+            continue;
         }
-        j = (j + right) % grid.no_of_cols;
-        n += int(grid.array[i][j] == '#');
+        rows[s] = (begin <= down ? down : (begin + down - 1) / down * down);
+        cols[s] = (rows[s] / down) % grid.no_of_cols * steps[s] % grid.no_of_cols;
     }
-    return n;
+    for(std::size_t i = begin; i < end; ++i){
+        for(std::size_t s = 0; s < slopes.size(); ++s){
+            if(rows[s] != i){
+                continue;
+            }
+            counts[s] += std::size_t(grid.tree(i, cols[s]));
+            cols[s] += steps[s];
+            if(cols[s] >= grid.no_of_cols){
+                cols[s] -= grid.no_of_cols;
+            }
+            rows[s] += slopes[s].down;
+        }
+    }
+    return counts;
+}
+
+template<typename P, typename Slopes>
+constexpr auto count_slopes(P const& grid, Slopes const& slopes) noexcept{
+    return count_slopes(grid, slopes, 0, grid.no_of_rows);
+}
+
+/*
+ * Parallel counting - the rows split into chunks of `chunk_rows`, counted
+ * on `threads` threads (0 for one per core) and added up at the end
+ */
+constexpr std::size_t chunk_rows = std::size_t(1) << 16;
+
+template<typename P, typename Slopes>
+inline auto count_slopes_parallel(P const& grid, Slopes const& slopes, std::size_t threads) noexcept{
+    auto chunks = (grid.no_of_rows + chunk_rows - 1) / chunk_rows;
+    threads = (threads == 0 ? default_threads() : threads);
+    auto partial = std::vector<decltype(storage_for<std::size_t>(slopes))>(threads, storage_for<std::size_t>(slopes));
+    run_parallel(chunks, threads, [&](std::size_t chunk, std::size_t thread){
+        auto begin = chunk * chunk_rows;
+        auto end = (begin + chunk_rows < grid.no_of_rows ? begin + chunk_rows : grid.no_of_rows);
+        auto counts = count_slopes(grid, slopes, begin, end);
+        for(std::size_t s = 0; s < slopes.size(); ++s){
+            partial[thread][s] += counts[s];
+        }
+    });
+    auto counts = storage_for<std::size_t>(slopes);
+    for(auto const& thread_counts : partial){
+        for(std::size_t s = 0; s < slopes.size(); ++s){
+            counts[s] += thread_counts[s];
+        }
+    }
+    return counts;
+}
+
+/*
+ * Slope queries - one map asked about any number of slopes
+ *
+ * For every `right` below `max_tabled_right` the index keeps the column
+ * the slope reaches on each of its steps, over one period of the width, so
+ * a query only walks its rows, adding up bits with no branch per square
+ * Answers are cached per slope, with `right` taken modulo the width, up to
+ * `max_cached_slopes` of them, and the index can be queried from any number
+ * of threads at once, each lookup only sharing the cache's lock
+ */
+constexpr std::size_t max_tabled_right = 64;
+constexpr std::size_t max_cached_slopes = std::size_t{1} << 20;
+
+struct SlopeIndex{
+    PackedGrid<std::vector<std::uint64_t>> const& grid;
+    std::vector<std::vector<std::uint32_t>> columns;
+
+    mutable std::shared_mutex mutex;
+    mutable std::unordered_map<std::uint64_t, std::size_t> cache;
+
+    explicit SlopeIndex(PackedGrid<std::vector<std::uint64_t>> const& grid) noexcept : grid{grid}{
+        auto no_of_cols = grid.no_of_cols;
+        auto rights = (no_of_cols < max_tabled_right ? no_of_cols : max_tabled_right);
+        columns.resize(rights);
+        for(std::size_t right = 0; right < rights; ++right){
+            auto& column = columns[right];
+            column.resize(no_of_cols);
+            for(std::size_t k = 0; k < no_of_cols; ++k){
+                column[k] = std::uint32_t(k * right % no_of_cols);
+            }
+        }
+    }
+
+    std::size_t count(std::size_t right, std::size_t down) const noexcept{
+        if(grid.no_of_cols == 0 || down == 0){
+            return 0;
+        }
+        right %= grid.no_of_cols;
+        if(right >= columns.size()){
+            return count_slopes(grid, std::array<Slope, 1>{{{right, down}}})[0];
+        }
+        auto const* column = columns[right].data();
+        auto const* words = grid.words.data();
+        auto words_per_row = grid.words_per_row;
+        std::size_t n = 0;
+        std::size_t k = 1;
+        for(auto i = down; i < grid.no_of_rows; i += down){
+            k = (k == grid.no_of_cols ? 0 : k);
+            auto j = column[k++];
+            n += (words[i * words_per_row + j / 64] >> (j % 64)) & 1;
+        }
+        return n;
+    }
+
+    std::size_t query(std::size_t right, std::size_t down) const noexcept{
+        // Any slope going down the whole map at once meets no tree
+        if(grid.no_of_cols == 0 || down == 0 || down >= grid.no_of_rows){
+            return 0;
+        }
+        // Unique, as down < rows, and no larger than the grid's number of squares
+        auto key = std::uint64_t(right % grid.no_of_cols) * grid.no_of_rows + down;
+        {
+            auto lock = std::shared_lock{mutex};
+            auto cached = cache.find(key);
+            if(cached != cache.end()){
+                return cached->second;
+            }
+        }
+        auto n = count(right, down);
+        auto lock = std::unique_lock{mutex};
+        if(cache.size() < max_cached_slopes){
+            cache.emplace(key, n);
+        }
+        return n;
+    }
+
+    // Every slope of the batch, spread over `threads` threads
+    std::vector<std::size_t> query(std::vector<Slope> const& slopes, std::size_t threads) const noexcept{
+        auto answers = std::vector<std::size_t>(slopes.size());
+        constexpr std::size_t batch = 256;
+        run_parallel((slopes.size() + batch - 1) / batch, threads, [&](std::size_t job, std::size_t){
+            auto end = (job * batch + batch < slopes.size() ? job * batch + batch : slopes.size());
+            for(auto i = job * batch; i < end; ++i){
+                answers[i] = query(slopes[i].right, slopes[i].down);
+            }
+        });
+        return answers;
+    }
+};
+
+/*
+ * Query mode - `./run <input> <threads> <queries>` answers every
+ * `right down` line of the queries file against one index, printing the
+ * answers in order and the query throughput to stderr
+ */
+inline int run_queries(PackedGrid<std::vector<std::uint64_t>> const& grid, std::size_t threads, char const* path) noexcept{
+    auto queries_file = map_input(path);
+    if(!queries_file){
+        return 1;
+    }
+    auto numbers = profile("parse_queries", [&]{ return parse_integers<std::size_t>(queries_file->text()); });
+    auto slopes = std::vector<Slope>(numbers.size() / 2);
+    for(std::size_t i = 0; i < slopes.size(); ++i){
+        slopes[i] = Slope{numbers[2 * i], numbers[2 * i + 1]};
+    }
+    threads = (threads == 0 ? default_threads() : threads);
+    auto start = std::chrono::steady_clock::now();
+    auto index = profile("build_index", [&]{ return std::make_unique<SlopeIndex>(grid); });
+    auto built = std::chrono::steady_clock::now();
+    auto answers = profile("query", [&]{ return index->query(slopes, threads); });
+    auto done = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < slopes.size(); ++i){
+        std::printf("right %lu, down %lu = %lu\n", slopes[i].right, slopes[i].down, answers[i]);
+    }
+    auto build_ms = std::chrono::duration<double, std::milli>(built - start).count();
+    auto query_ms = std::chrono::duration<double, std::milli>(done - built).count();
+    std::fprintf(stderr, "index of %lu rows built in %.3f ms, %lu queries (%lu cached) on %lu threads in %.3f ms, %.0f queries/s\n",
+        grid.no_of_rows, build_ms, slopes.size(), index->cache.size(), threads, query_ms,
+        query_ms > 0 ? double(slopes.size()) / query_ms * 1000 : 0.0);
+    return 0;
 }
 
 constexpr static auto input = make_grid(
@@ -364,24 +682,46 @@ constexpr static auto input = make_grid(
     ".....####.#....#.#............."
 );
 
-constexpr static auto trees_0 = count_trees<1, 1>(input);
-constexpr static auto trees_1 = count_trees<3, 1>(input);
-constexpr static auto trees_2 = count_trees<5, 1>(input);
-constexpr static auto trees_3 = count_trees<7, 1>(input);
-constexpr static auto trees_4 = count_trees<1, 2>(input);
+constexpr static auto slopes = std::array<Slope, 5>{{
+    {1, 1},
+    {3, 1},
+    {5, 1},
+    {7, 1},
+    {1, 2}
+}};
 
-constexpr static auto trees = trees_0
-                            * trees_1
-                            * trees_2
-                            * trees_3
-                            * trees_4;
+constexpr static auto count_all_trees = [](auto const& grid){
+    return count_slopes(pack_grid(grid), slopes);
+};
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto packed = profile("pack_grid", [&]{ return pack_grid(input->text()); });
+        auto threads = (argc > 2 ? std::size_t(std::strtoul(argv[2], nullptr, 10)) : 1);
+        if(argc > 3){
+            return run_queries(packed, threads, argv[3]);
+        }
+        auto [trees_0, trees_1, trees_2, trees_3, trees_4] = (threads == 1
+            ? profile("count_slopes", [&]{ return count_slopes(packed, slopes); })
+            : profile("count_slopes_parallel", [&]{ return count_slopes_parallel(packed, slopes, threads); }));
+        std::printf("right 1, down 1 = %lu\n", trees_0);
+        std::printf("right 3, down 1 = %lu\n", trees_1);
+        std::printf("right 5, down 1 = %lu\n", trees_2);
+        std::printf("right 7, down 1 = %lu\n", trees_3);
+        std::printf("right 1, down 2 = %lu\n", trees_4);
+        std::printf("product         = %lu\n", trees_0 * trees_1 * trees_2 * trees_3 * trees_4);
+        return 0;
+    }
+    auto const& [trees_0, trees_1, trees_2, trees_3, trees_4] = evaluate<input, count_all_trees>();
     std::printf("right 1, down 1 = %lu\n", trees_0);
     std::printf("right 3, down 1 = %lu\n", trees_1);
     std::printf("right 5, down 1 = %lu\n", trees_2);
     std::printf("right 7, down 1 = %lu\n", trees_3);
     std::printf("right 1, down 2 = %lu\n", trees_4);
-    std::printf("product         = %lu\n", trees);
+    std::printf("product         = %lu\n", trees_0 * trees_1 * trees_2 * trees_3 * trees_4);
     return 0;
 }
@@ -1 +1 @@
-g++ -O3 -std=c++17 -o run run.cpp
+g++ -O3 -std=c++17 -pthread -o run run.cpp
@@ -0,0 +1,122 @@
+/*
+ * Parity check - `./parity [rounds] [seed]` holds the tokenized count to
+ * `count_valid` on fixed passports and on `rounds` texts of random ones,
+ * printing the first text they disagree on
+ * Built on its own by parity.sh, so the solver carries none of it
+ */
+#include <random>
+#include <string>
+
+#define main day_04_main
+#include "run.cpp"
+#undef main
+
+/*
+ * Passports with zero-padded values the token validators once turned down
+ */
+constexpr static char parity_passports[] =
+    "byr:0000001920 iyr:2010 eyr:2020 hgt:000000000170cm\n"
+    "hcl:#123abc ecl:brn pid:000000001\n"
+    "\n"
+    "byr:00000000000000000001937 iyr:02015 eyr:002025 hgt:00000000000000000000059in\n"
+    "hcl:#abcdef ecl:amb pid:123456789\n"
+    "\n"
+    "byr:0000001919 iyr:2010 eyr:2020 hgt:000000000170cm\n"
+    "hcl:#123abc ecl:brn pid:000000001\n";
+
+static_assert(count_valid(parity_passports) == 2);
+
+/*
+ * Random passports - every field close to its limits, with zero padding,
+ * wrong units and lengths, missing and unknown fields, and either separator
+ */
+struct Fuzzer{
+    std::mt19937_64 rng;
+
+    std::size_t below(std::size_t n) noexcept{
+        return std::size_t(rng() % n);
+    }
+
+    std::string number(int min, int max) noexcept{
+        auto value = min - 2 + int(below(std::size_t(max - min + 5)));
+        return std::string(below(4) == 0 ? below(24) : 0, '0') + std::to_string(value);
+    }
+
+    std::string value(std::size_t field) noexcept{
+        switch(field){
+            case 0: return number(1920, 2002);
+            case 1: return number(2010, 2020);
+            case 2: return number(2020, 2030);
+            case 3:{
+                auto cm = (below(2) == 0);
+                auto units = std::array<char const*, 4>{"cm", "in", "c", ""};
+                return (cm ? number(150, 193) : number(59, 76)) + units[below(8) == 0 ? 2 + below(2) : !cm];
+            }
+            case 4:{
+                auto colour = std::string(below(8) == 0 ? "" : "#");
+                for(std::size_t i = 0, n = 5 + below(3); i < n; ++i){
+                    colour += "0123456789abcdefg"[below(17)];
+                }
+                return colour;
+            }
+            case 5:{
+                auto choices = std::array<char const*, 10>{"amb", "blu", "brn", "gry", "grn", "hzl", "oth", "xyz", "am", "ambb"};
+                return choices[below(choices.size())];
+            }
+            case 6:{
+                auto pid = std::string{};
+                for(std::size_t i = 0, n = 8 + below(3); i < n; ++i){
+                    pid += char('0' + below(10));
+                }
+                return pid;
+            }
+            default: return std::to_string(below(1000));
+        }
+    }
+
+    std::string passports() noexcept{
+        constexpr auto keys = std::array<char const*, 9>{"byr", "iyr", "eyr", "hgt", "hcl", "ecl", "pid", "cid", "zzz"};
+        auto text = std::string{};
+        for(std::size_t p = 0, n = 1 + below(8); p < n; ++p){
+            auto order = std::array<std::size_t, keys.size()>{0, 1, 2, 3, 4, 5, 6, 7, 8};
+            std::shuffle(order.begin(), order.end(), rng);
+            auto first = true;
+            for(auto field : order){
+                if(below(12) == 0){
+                    continue;
+                }
+                text += (first ? "" : below(3) == 0 ? "\n" : " ");
+                text += std::string(keys[field]) + ":" + value(field);
+                first = false;
+            }
+            text += (p + 1 < n ? "\n\n" : below(2) == 0 ? "\n" : "");
+        }
+        return text;
+    }
+};
+
+int main(int argc, char** argv){
+    auto rounds = (argc > 1 ? std::size_t(std::strtoul(argv[1], nullptr, 10)) : 100000);
+    auto seed = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1);
+    auto parity = count_valid_tokenized(parity_passports);
+    if(parity != count_valid(parity_passports)){
+        std::fprintf(stderr, "tokenized count %lu of the parity passports differs from scalar count %lu\n",
+            parity, count_valid(parity_passports));
+        return 1;
+    }
+    auto fuzzer = Fuzzer{std::mt19937_64{seed}};
+    std::size_t valid = 0;
+    for(std::size_t round = 0; round < rounds; ++round){
+        auto text = fuzzer.passports();
+        auto tokenized = count_valid_tokenized(text);
+        auto scalar = count_valid(text.c_str());
+        if(tokenized != scalar){
+            std::fprintf(stderr, "round %lu: tokenized count %lu differs from scalar count %lu on\n%s\n",
+                round, tokenized, scalar, text.c_str());
+            return 1;
+        }
+        valid += scalar;
+    }
+    std::printf("%lu rounds agree, %lu valid passports\n", rounds, valid);
+    return 0;
+}
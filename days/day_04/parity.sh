@@ -0,0 +1 @@
+g++ -O3 -std=c++17 -pthread -o parity parity.cpp
@@ -1,28 +1,22 @@
+#include <chrono>
 #include <cstdio>
 #include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/pool.hpp"
+#include "../common/profile.hpp"
+#include "../common/records.hpp"
+#include "../common/scratch.hpp"
+#include "../common/evaluate.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
 
-constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
-    std::int32_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 constexpr auto is_whitespace(char c) noexcept{
     return c == ' ' || c == '\n' || c == '\0';
 }
@@ -35,16 +29,6 @@ constexpr auto is_hex(char c) noexcept{
     return is_digit(c) || ('a' <= c && c <= 'f');
 }
 
-template<std::size_t n>
-constexpr void skip(char const* str, char const** endptr) noexcept{
-    for(std::size_t i = 0; i < n; ++i){
-        ++str;
-    }
-    if(endptr){
-        *endptr = str;
-    }
-}
-
 constexpr auto skip_until_whitespace(char const* str, char const** endptr){
     bool v = is_whitespace(*str);
     while(!is_whitespace(*str)){
@@ -56,186 +40,685 @@ constexpr auto skip_until_whitespace(char const* str, char const** endptr){
     return v;
 }
 
-template<std::size_t size>
-constexpr auto match(char const* str, CharConstPtr<size> m) noexcept{
-    constexpr auto n = size - 1;
+/*
+ * Field schema - every field is a row of data, its key, what kind of value
+ * it takes and whether a passport needs it, and the validators below read
+ * their limits from it, so a new rule is a new row rather than new code
+ *
+ * Keys, units and choices are packed into integers, one byte per character
+ */
+constexpr std::uint32_t pack(char const* str, std::size_t n) noexcept{
+    std::uint32_t packed = 0;
     for(std::size_t i = 0; i < n; ++i){
-        if(str[i] != m[i]){
-            return false;
+        packed |= std::uint32_t(std::uint8_t(str[i])) << (8 * i);
+    }
+    return packed;
+}
+
+template<std::size_t size>
+constexpr std::uint32_t pack(CharConstPtr<size> str) noexcept{
+    return pack(str, size - 1);
+}
+
+enum class Kind : std::uint8_t{
+    ignored,  // anything
+    range,    // a number within [min, max]
+    measure,  // a number followed by one of the units, within that unit's range
+    colour,   // '#' and six lower case hex digits
+    choice,   // one of the choices
+    digits    // exactly `width` digits
+};
+
+constexpr std::size_t max_units = 2;
+constexpr std::size_t max_choices = 8;
+
+struct Field{
+    std::uint32_t key;
+    Kind kind;
+    bool required;
+    std::size_t width;
+    std::size_t no_of_units;
+    std::uint32_t units[max_units];
+    std::int32_t min[max_units];
+    std::int32_t max[max_units];
+    std::size_t no_of_choices;
+    std::uint32_t choices[max_choices];
+};
+
+template<std::size_t size>
+constexpr Field ignored_field(CharConstPtr<size> key) noexcept{
+    return Field{pack(key), Kind::ignored, false, 0, 0, {}, {}, {}, 0, {}};
+}
+
+template<std::size_t size>
+constexpr Field range_field(CharConstPtr<size> key, std::int32_t min, std::int32_t max) noexcept{
+    return Field{pack(key), Kind::range, true, 0, 1, {}, {min}, {max}, 0, {}};
+}
+
+template<std::size_t size>
+constexpr Field colour_field(CharConstPtr<size> key) noexcept{
+    return Field{pack(key), Kind::colour, true, 7, 0, {}, {}, {}, 0, {}};
+}
+
+template<std::size_t size>
+constexpr Field digits_field(CharConstPtr<size> key, std::size_t width) noexcept{
+    return Field{pack(key), Kind::digits, true, width, 0, {}, {}, {}, 0, {}};
+}
+
+// The units as `"cm", 150, 193, "in", 59, 76`
+template<std::size_t size>
+constexpr Field measure_field(CharConstPtr<size> key,
+        CharConstPtr<3> unit_0, std::int32_t min_0, std::int32_t max_0,
+        CharConstPtr<3> unit_1, std::int32_t min_1, std::int32_t max_1) noexcept{
+    return Field{pack(key), Kind::measure, true, 0, 2, {pack(unit_0), pack(unit_1)}, {min_0, min_1}, {max_0, max_1}, 0, {}};
+}
+
+template<std::size_t size, std::size_t... sizes>
+constexpr Field choice_field(CharConstPtr<size> key, CharConstPtr<sizes>... choices) noexcept{
+    static_assert(sizeof...(sizes) <= max_choices);
+    return Field{pack(key), Kind::choice, true, 3, 0, {}, {}, {}, sizeof...(sizes), {pack(choices)...}};
+}
+
+constexpr static auto schema = std::array<Field, 8>{
+    range_field("byr", 1920, 2002),
+    range_field("iyr", 2010, 2020),
+    range_field("eyr", 2020, 2030),
+    measure_field("hgt", "cm", 150, 193, "in", 59, 76),
+    colour_field("hcl"),
+    choice_field("ecl", "amb", "blu", "brn", "gry", "grn", "hzl", "oth"),
+    digits_field("pid", 9),
+    ignored_field("cid")
+};
+
+/*
+ * Dispatch - a perfect hash of the packed three character keys, found by
+ * the compiler: the top `bits` bits of `key * multiplier` differ for every
+ * key in the schema, so one multiply and one table lookup find the field
+ * A slot holds the field's index plus one, or 0 for no field
+ */
+constexpr std::size_t hash_bits = 4;
+
+struct Dispatch{
+    std::uint32_t multiplier;
+    std::array<std::uint8_t, std::size_t(1) << hash_bits> slots;
+
+    constexpr std::size_t slot(std::uint32_t key) const noexcept{
+        return std::uint32_t(key * multiplier) >> (32 - hash_bits);
+    }
+};
+
+template<typename Schema>
+constexpr auto make_dispatch(Schema const& schema) noexcept{
+    // Odd multipliers from 2^32 / golden ratio on, which spread the keys well
+    for(std::uint32_t multiplier = 0x9E3779B1; multiplier != 1; multiplier += 2){
+        auto dispatch = Dispatch{multiplier, {}};
+        auto perfect = true;
+        for(std::size_t i = 0; i < schema.size() && perfect; ++i){
+            auto& slot = dispatch.slots[dispatch.slot(schema[i].key)];
+            perfect = (slot == 0);
+            slot = std::uint8_t(i + 1);
+        }
+        if(perfect){
+            return dispatch;
         }
     }
-    return true;
+    return Dispatch{0, {}};
 }
 
-// Valid fields
+constexpr static auto dispatch = make_dispatch(schema);
+static_assert(dispatch.multiplier != 0, "no perfect hash for the schema's keys");
 
-constexpr auto valid_byr(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    auto year = str_to_int(str, &str);
-    bool v = (1920 <= year && year <= 2002);
-    v &= skip_until_whitespace(str, &str);
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+constexpr auto required_fields() noexcept{
+    std::uint32_t mask = 0;
+    for(std::size_t i = 0; i < schema.size(); ++i){
+        mask |= std::uint32_t(schema[i].required) << i;
     }
-    return v;
+    return mask;
 }
 
-constexpr auto valid_iyr(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    auto year = str_to_int(str, &str);
-    bool v = (2010 <= year && year <= 2020);
-    v &= skip_until_whitespace(str, &str);
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+/*
+ * Validators - each reads as much of the value at `str` as its kind allows,
+ * handing back where it stopped, and the value is valid when that is the
+ * whitespace after it
+ */
+constexpr auto read_number(char const* str, char const** endptr) noexcept{
+    std::int32_t number = 0;
+    auto const* start = str;
+    // Saturating well above any limit, rather than overflowing on a long run
+    for(; is_digit(*str); ++str){
+        number = (number < 100000000 ? number * 10 + (*str - '0') : 999999999);
     }
-    return v;
+    *endptr = str;
+    return str != start ? number : -1;
 }
 
-constexpr auto valid_eyr(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    auto year = str_to_int(str, &str);
-    bool v = (2020 <= year && year <= 2030);
-    v &= skip_until_whitespace(str, &str);
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+constexpr auto valid_value(Field const& field, char const* str, char const** endptr) noexcept{
+    auto v = true;
+    switch(field.kind){
+        case Kind::ignored:
+            break;
+        case Kind::range:{
+            auto number = read_number(str, &str);
+            v = (field.min[0] <= number && number <= field.max[0]);
+            break;
+        }
+        case Kind::measure:{
+            auto number = read_number(str, &str);
+            v = !is_whitespace(str[0]) && !is_whitespace(str[1]);
+            if(v){
+                auto unit = pack(str, 2);
+                str += 2;
+                v = false;
+                for(std::size_t i = 0; i < field.no_of_units; ++i){
+                    v |= (unit == field.units[i] && field.min[i] <= number && number <= field.max[i]);
+                }
+            }
+            break;
+        }
+        case Kind::colour:{
+            v = (*str == '#');
+            std::size_t i = 1;
+            for(str += std::size_t(v); v && i < field.width && is_hex(*str); ++i){
+                ++str;
+            }
+            v &= (i == field.width);
+            break;
+        }
+        case Kind::choice:{
+            std::size_t i = 0;
+            for(; i < 3 && !is_whitespace(str[i]); ++i);
+            v = false;
+            if(i == 3){
+                auto choice = pack(str, 3);
+                for(std::size_t j = 0; j < field.no_of_choices; ++j){
+                    v |= (choice == field.choices[j]);
+                }
+            }
+            str += i;
+            break;
+        }
+        case Kind::digits:{
+            std::size_t i = 0;
+            for(; i < field.width && is_digit(*str); ++i){
+                ++str;
+            }
+            v = (i == field.width);
+            break;
+        }
     }
-    return v;
+    *endptr = str;
+    return v && is_whitespace(*str);
 }
 
-constexpr auto valid_hgt(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    auto height = str_to_int(str, &str);
-    auto is_cm = match(str, "cm");
-    auto is_in = match(str, "in");
-    bool v = true;
-    if(is_cm || is_in){
-        skip<2>(str, &str);
-        v = is_cm ? (150 <= height && height <= 193)
-                  : (59 <= height && height <= 76);
-    } else{
+// The packed key of a field starting at `str`, or 0 when it is not one
+constexpr std::uint32_t read_key(char const* str) noexcept{
+    return (str[0] != '\0' && str[1] != '\0' && str[2] != '\0' && str[3] == ':') ? pack(str, 3) : 0;
+}
+
+/*
+ * Count the passports with every required field present and valid
+ *
+ * Every field is `key:value` followed by a space or a newline, and a
+ * newline where a field should start is the blank line ending a passport
+ * An unknown key is skipped like an ignored one
+ */
+constexpr auto count_valid(char const* str) noexcept{
+    constexpr auto required = required_fields();
+    std::uint32_t valid_fields = 0;
+    std::size_t n = 0;
+    while(*str != '\0'){
+        if(*str == '\n'){
+            n += std::size_t((valid_fields & required) == required);
+            valid_fields = 0;
+            ++str;
+            continue;
+        }
+        auto key = read_key(str);
+        auto slot = dispatch.slots[dispatch.slot(key)];
+        auto known = (slot != 0 && schema[slot - 1].key == key);
+        if(known && valid_value(schema[slot - 1], str + 4, &str)){
+            valid_fields |= std::uint32_t(1) << (slot - 1);
+        }
         skip_until_whitespace(str, &str);
-        v = false;
+        if(*str != '\0'){
+            ++str;
+        }
     }
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+    n += std::size_t((valid_fields & required) == required);
+    return n;
+}
+
+/*
+ * Tokenizer - the text is classified 64 characters at a time into masks of
+ * its spaces and newlines, and walking the set bits of those jumps from one
+ * field to the next without looking at the characters in between
+ * Tokens are exactly the fields `count_valid` would look at: a key of three
+ * characters and a colon, from the start of the text or after a separator,
+ * with a newline where a field should start ending the passport
+ *
+ * Every field of the schema comes out as a (passport, value offset, value
+ * length) tuple in the column of its key, for a batch of passports at a
+ * time, so that the validators then run down one column at a time, always
+ * doing the same kind of check
+ */
+constexpr std::size_t batch_passports = 1024;
+
+// Longer values are cut to this length, and read again from the text when it matters
+constexpr std::size_t max_token_length = 65535;
+
+struct Token{
+    std::uint32_t offset;    // of the value, from the start of the batch
+    std::uint16_t length;    // of the value, at most `max_token_length`
+    std::uint16_t passport;  // within the batch
+};
+
+struct Batch{
+    char const* base;
+    std::size_t no_of_passports;
+    std::array<std::vector<Token>, schema.size()> columns;
+};
+
+struct Separators{
+    std::uint64_t spaces;
+    std::uint64_t newlines;
+};
+
+// Uses AVX2 or SSE2 when the compiler has been allowed to
+inline Separators separator_masks(char const* str) noexcept{
+    auto masks = Separators{0, 0};
+#if defined(__AVX2__)
+    auto space = _mm256_set1_epi8(' ');
+    auto newline = _mm256_set1_epi8('\n');
+    for(std::size_t i = 0; i < 64; i += 32){
+        auto chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(str + i));
+        masks.spaces |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, space)))) << i;
+        masks.newlines |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newline)))) << i;
     }
-    return v;
+#elif defined(__SSE2__)
+    auto space = _mm_set1_epi8(' ');
+    auto newline = _mm_set1_epi8('\n');
+    for(std::size_t i = 0; i < 64; i += 16){
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str + i));
+        masks.spaces |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, space)))) << i;
+        masks.newlines |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline)))) << i;
+    }
+#else
+    for(std::size_t i = 0; i < 64; ++i){
+        masks.spaces |= std::uint64_t(str[i] == ' ') << i;
+        masks.newlines |= std::uint64_t(str[i] == '\n') << i;
+    }
+#endif
+    return masks;
 }
 
-constexpr auto valid_hcl(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    bool v = true;
-    v &= (*str == '#');
-    if(v){
-        ++str;
-        for(std::size_t i = 0; i < 6; ++i){
-            v &= is_hex(*str);
-            if(!v){
-                break;
+// The last block, shorter than 64 characters
+inline Separators separator_masks(char const* str, std::size_t n) noexcept{
+    auto masks = Separators{0, 0};
+    for(std::size_t i = 0; i < n; ++i){
+        masks.spaces |= std::uint64_t(str[i] == ' ') << i;
+        masks.newlines |= std::uint64_t(str[i] == '\n') << i;
+    }
+    return masks;
+}
+
+// `on_batch(batch)` for every `batch_passports` passports, and the rest
+template<typename F>
+inline void tokenize(std::string_view text, Batch& batch, F&& on_batch){
+    auto const* base = text.data();
+    auto size = text.size();
+    std::size_t start = 0;
+    batch.base = base;
+    batch.no_of_passports = 0;
+    for(auto& column : batch.columns){
+        column.clear();
+    }
+
+    auto end_token = [&](std::size_t end){
+        if(end - start < 4 || base[start + 3] != ':'){
+            return;
+        }
+        auto key = pack(base + start, 3);
+        auto slot = dispatch.slots[dispatch.slot(key)];
+        if(slot != 0 && schema[slot - 1].key == key){
+            auto length = end - start - 4;
+            batch.columns[slot - 1].push_back(Token{std::uint32_t(base + start + 4 - batch.base),
+                std::uint16_t(length < max_token_length ? length : max_token_length), std::uint16_t(batch.no_of_passports)});
+        }
+    };
+    auto end_passport = [&](std::size_t next){
+        if(++batch.no_of_passports == batch_passports){
+            on_batch(batch);
+            batch.base = base + next;
+            batch.no_of_passports = 0;
+            for(auto& column : batch.columns){
+                column.clear();
             }
-            ++str;
         }
-        v &= skip_until_whitespace(str, &str);
-    } else{
-        v = false;
-        skip_until_whitespace(str, &str);
+    };
+
+    for(std::size_t block = 0; block < size; block += 64){
+        auto masks = (size - block >= 64 ? separator_masks(base + block) : separator_masks(base + block, size - block));
+        for(auto bits = masks.spaces | masks.newlines; bits != 0; bits &= bits - 1){
+            auto i = std::size_t(__builtin_ctzll(bits));
+            auto p = block + i;
+            if(p != start){
+                end_token(p);
+            } else if((masks.newlines >> i) & 1){
+                end_passport(p + 1);
+            }
+            start = p + 1;
+        }
     }
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+    if(start < size){
+        end_token(size);
     }
-    return v;
+    ++batch.no_of_passports;
+    on_batch(batch);
 }
 
-constexpr auto valid_ecl(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    bool v = false;
-    v |= match(str, "amb");
-    v |= match(str, "blu");
-    v |= match(str, "brn");
-    v |= match(str, "gry");
-    v |= match(str, "grn");
-    v |= match(str, "hzl");
-    v |= match(str, "oth");
-    if(v){
-        skip<3>(str, &str);
-    } else{
-        v = false;
-        skip_until_whitespace(str, &str);
+/*
+ * Validators over tokens - the length of a value is already known, so it
+ * is read to its end without stopping early, and how far a loop runs then
+ * depends on the field alone
+ */
+inline auto read_digits(char const* str, std::size_t length, std::int32_t& number) noexcept{
+    auto digits = (length > 0);
+    std::uint32_t value = 0;
+    // Saturating just as `read_number` does, so leading zeros are read the same
+    for(std::size_t i = 0; i < length; ++i){
+        digits &= is_digit(str[i]);
+        value = (value < 100000000 ? value * 10 + std::uint32_t(str[i] - '0') : 999999999);
     }
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
-    }
-    return v;
+    number = std::int32_t(value);
+    return digits;
 }
 
-constexpr auto valid_pid(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    bool v = true;
-    for(std::size_t i = 0; i < 9; ++i){
-        v &= is_digit(*str);
-        if(!v){
-            break;
+/*
+ * Diagnostics - why each value failed, for explaining a count rather than
+ * just giving it
+ * The validators report into a policy chosen at compile time: `NoDiagnostics`
+ * does nothing and compiles away entirely, leaving the same machine code as
+ * if it were not there, while `FieldDiagnostics` keeps a histogram of the
+ * failures of every field
+ * Like the allocation accounting there is one histogram for the process, so
+ * it is meant for counting on one thread
+ */
+enum class Failure : std::uint8_t{
+    missing,       // a required field not in the passport
+    length,        // the wrong number of characters
+    not_a_number,  // not made of digits where digits were needed
+    format,        // not '#' and hex digits
+    unit,          // no unit, or one the field does not take
+    out_of_range,  // a number outside the range of the field or its unit
+    choice         // none of the choices
+};
+
+constexpr std::size_t no_of_failures = 7;
+
+constexpr static char const* failure_names[no_of_failures] = {
+    "missing", "length", "not_a_number", "format", "unit", "out_of_range", "choice"
+};
+
+struct NoDiagnostics{
+    constexpr static bool enabled = false;
+
+    constexpr static void pass(std::size_t) noexcept{}
+    constexpr static void fail(std::size_t, Failure) noexcept{}
+    constexpr static void passport(bool) noexcept{}
+};
+
+struct FieldDiagnostics{
+    constexpr static bool enabled = true;
+
+    inline static std::size_t passports = 0;
+    inline static std::size_t valid_passports = 0;
+    inline static std::array<std::size_t, schema.size()> valid = {};
+    inline static std::array<std::array<std::size_t, no_of_failures>, schema.size()> failures = {};
+
+    static void pass(std::size_t slot) noexcept{
+        ++valid[slot];
+    }
+    static void fail(std::size_t slot, Failure failure) noexcept{
+        ++failures[slot][std::size_t(failure)];
+    }
+    static void passport(bool v) noexcept{
+        ++passports;
+        valid_passports += std::size_t(v);
+    }
+
+    static void report(std::FILE* file) noexcept{
+        std::fprintf(file, "%lu passports, %lu valid\n%-5s %10s", passports, valid_passports, "field", "valid");
+        for(auto const* name : failure_names){
+            std::fprintf(file, " %12s", name);
+        }
+        std::fprintf(file, "\n");
+        for(std::size_t slot = 0; slot < schema.size(); ++slot){
+            if(schema[slot].kind == Kind::ignored){
+                continue;
+            }
+            auto key = schema[slot].key;
+            std::fprintf(file, "%c%c%c   %10lu", char(key), char(key >> 8), char(key >> 16), valid[slot]);
+            for(auto count : failures[slot]){
+                std::fprintf(file, " %12lu", count);
+            }
+            std::fprintf(file, "\n");
         }
-        ++str;
     }
-    v &= skip_until_whitespace(str, &str);
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+};
+
+inline bool valid_token(Field const& field, char const* str, std::size_t length) noexcept{
+    std::int32_t number = 0;
+    switch(field.kind){
+        case Kind::ignored:
+            return true;
+        case Kind::range:
+            if(length == max_token_length){
+                return valid_value(field, str, &str);
+            }
+            return read_digits(str, length, number) && field.min[0] <= number && number <= field.max[0];
+        case Kind::measure:{
+            if(length == max_token_length){
+                return valid_value(field, str, &str);
+            }
+            if(length < 3 || !read_digits(str, length - 2, number)){
+                return false;
+            }
+            auto unit = pack(str + length - 2, 2);
+            auto v = false;
+            for(std::size_t i = 0; i < field.no_of_units; ++i){
+                v |= (unit == field.units[i] && field.min[i] <= number && number <= field.max[i]);
+            }
+            return v;
+        }
+        case Kind::colour:{
+            if(length != field.width || str[0] != '#'){
+                return false;
+            }
+            auto v = true;
+            for(std::size_t i = 1; i < field.width; ++i){
+                v &= is_hex(str[i]);
+            }
+            return v;
+        }
+        case Kind::choice:{
+            if(length != 3){
+                return false;
+            }
+            auto choice = pack(str, 3);
+            auto v = false;
+            for(std::size_t j = 0; j < field.no_of_choices; ++j){
+                v |= (choice == field.choices[j]);
+            }
+            return v;
+        }
+        case Kind::digits:
+            return length == field.width && read_digits(str, length, number);
     }
-    return v;
+    return false;
 }
 
-constexpr auto valid_cid(char const* str, char const** endptr) noexcept{
-    skip<4>(str, &str);
-    skip_until_whitespace(str, &str);
-    skip<1>(str, &str);
-    if(endptr){
-        *endptr = str;
+// Why a value `valid_token` turned down failed, looked at only for those
+inline Failure failure_of(Field const& field, char const* str, std::size_t length) noexcept{
+    std::int32_t number = 0;
+    switch(field.kind){
+        case Kind::range:
+            return !read_digits(str, length, number) ? Failure::not_a_number : Failure::out_of_range;
+        case Kind::measure:{
+            // Nothing, or more than a token holds, is the only wrong length
+            if(length == 0 || length == max_token_length){
+                return Failure::length;
+            }
+            // A number alone, of any length, is missing its unit
+            if(read_digits(str, length, number)){
+                return Failure::unit;
+            }
+            if(length < 3 || !read_digits(str, length - 2, number)){
+                return Failure::not_a_number;
+            }
+            auto unit = pack(str + length - 2, 2);
+            auto known = false;
+            for(std::size_t i = 0; i < field.no_of_units; ++i){
+                known |= (unit == field.units[i]);
+            }
+            return known ? Failure::out_of_range : Failure::unit;
+        }
+        case Kind::colour:
+            return length != field.width ? Failure::length : Failure::format;
+        case Kind::choice:
+            return length != 3 ? Failure::length : Failure::choice;
+        case Kind::digits:
+            return length != field.width ? Failure::length : Failure::not_a_number;
+        default:
+            return Failure::format;
     }
-    return true;
 }
 
-constexpr auto count_valid(char const* str) noexcept{
-    std::size_t validity = 0;
-    std::size_t n = 0;
-    while(*str != '\0'){
-        if(*str == '\n'){
-            n += int(validity == 7);
-            validity = 0;
-            if(*str == '\0'){
-                return n;
-            }
-            skip<1>(str, &str);
+template<typename Diagnostics>
+inline std::size_t count_valid_batch(Batch const& batch) noexcept{
+    constexpr auto required = required_fields();
+    auto& fields = scratch<std::array<std::uint32_t, batch_passports>, Batch>();
+    std::fill_n(fields.begin(), batch.no_of_passports, 0);
+    for(std::size_t slot = 0; slot < schema.size(); ++slot){
+        auto const& field = schema[slot];
+        if(!field.required){
             continue;
-        } else if(match(str, "byr")){
-            validity += int(valid_byr(str, &str));
-        } else if(match(str, "iyr")){
-            validity += int(valid_iyr(str, &str));
-        } else if(match(str, "eyr")){
-            validity += int(valid_eyr(str, &str));
-        } else if(match(str, "hgt")){
-            validity += int(valid_hgt(str, &str));
-        } else if(match(str, "hcl")){
-            validity += int(valid_hcl(str, &str));
-        } else if(match(str, "ecl")){
-            validity += int(valid_ecl(str, &str));
-        } else if(match(str, "pid")){
-            validity += int(valid_pid(str, &str));
-        } else if(match(str, "cid")){
-            valid_cid(str, &str);
         }
+        for(auto const& token : batch.columns[slot]){
+            auto v = valid_token(field, batch.base + token.offset, token.length);
+            fields[token.passport] |= std::uint32_t(v) << slot;
+            if constexpr(Diagnostics::enabled){
+                if(v){
+                    Diagnostics::pass(slot);
+                } else{
+                    Diagnostics::fail(slot, failure_of(field, batch.base + token.offset, token.length));
+                }
+            }
+        }
+    }
+    if constexpr(Diagnostics::enabled){
+        auto& present = scratch<std::array<std::uint32_t, batch_passports>, FieldDiagnostics>();
+        std::fill_n(present.begin(), batch.no_of_passports, 0);
+        for(std::size_t slot = 0; slot < schema.size(); ++slot){
+            for(auto const& token : batch.columns[slot]){
+                present[token.passport] |= std::uint32_t(1) << slot;
+            }
+        }
+        for(std::size_t i = 0; i < batch.no_of_passports; ++i){
+            for(auto missing = required & ~present[i]; missing != 0; missing &= missing - 1){
+                Diagnostics::fail(std::size_t(__builtin_ctz(missing)), Failure::missing);
+            }
+            Diagnostics::passport((fields[i] & required) == required);
+        }
+    }
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < batch.no_of_passports; ++i){
+        n += std::size_t((fields[i] & required) == required);
+    }
+    return n;
+}
+
+template<typename Diagnostics = NoDiagnostics>
+inline std::size_t count_valid_tokenized(std::string_view text) noexcept{
+    auto& batch = scratch<Batch>();
+    std::size_t n = 0;
+    tokenize(text, batch, [&](Batch const& tokens){
+        n += count_valid_batch<Diagnostics>(tokens);
+    });
+    return n;
+}
+
+/*
+ * Parallel validation - the text is cut into chunks of about `chunk_bytes`
+ * at blank lines, so that every passport lies whole in one chunk, and the
+ * chunks are counted on `threads` threads (0 for one per core) and added up
+ * at the end
+ */
+constexpr std::size_t chunk_bytes = std::size_t(1) << 18;
+
+struct alignas(64) ThreadCount{
+    std::size_t n = 0;
+};
+
+inline std::size_t count_valid_parallel(std::string_view text, std::size_t threads) noexcept{
+    auto chunks = split_records(text, chunk_bytes);
+    threads = (threads == 0 ? default_threads() : threads);
+    auto partial = std::vector<ThreadCount>(threads);
+    run_parallel(chunks.size(), threads, [&](std::size_t chunk, std::size_t thread){
+        partial[thread].n += count_valid_tokenized(chunks[chunk]);
+    });
+    std::size_t n = 0;
+    for(auto const& count : partial){
+        n += count.n;
     }
-    n += int(validity == 7);
     return n;
 }
 
+/*
+ * The passports, as the stretches between blank lines with more than newlines
+ * in them, so that blank lines at the end or a blank file add none
+ * With no blank line inside it, a stretch of newlines alone is at most one long
+ */
+inline std::size_t count_records(std::string_view text) noexcept{
+    auto const* end = text.data() + text.size();
+    auto filled = [](char const* start, char const* stop){
+        return stop - start > 1 || (stop - start == 1 && *start != '\n');
+    };
+    std::size_t n = 0;
+    auto const* start = text.data();
+    for(auto const* at = find_record_break(start, end); at != end; at = find_record_break(start, end)){
+        n += filled(start, at);
+        start = at + 2;
+    }
+    return n + filled(start, end);
+}
+
+/*
+ * Report the valid passports, and to stderr the records per second of the
+ * parallel count against `count_valid` on one thread over the same text
+ * Counting the records first also reads in the whole mapping, so neither
+ * count pays for its page faults
+ */
+inline int run_parallel_count(std::string_view text, char const* str, std::size_t threads) noexcept{
+    threads = (threads == 0 ? default_threads() : threads);
+    auto records = profile("count_records", [&]{ return count_records(text); });
+    auto start = std::chrono::steady_clock::now();
+    auto valid = profile("count_valid_parallel", [&]{ return count_valid_parallel(text, threads); });
+    auto parallel = std::chrono::steady_clock::now();
+    auto baseline = profile("count_valid", [&]{ return count_valid(str); });
+    auto scalar = std::chrono::steady_clock::now();
+    if(valid != baseline){
+        std::fprintf(stderr, "parallel count %lu differs from scalar count %lu\n", valid, baseline);
+        return 1;
+    }
+    std::printf("valid passports = %lu\n", valid);
+    auto parallel_ms = std::chrono::duration<double, std::milli>(parallel - start).count();
+    auto scalar_ms = std::chrono::duration<double, std::milli>(scalar - parallel).count();
+    std::fprintf(stderr, "%lu records on %lu threads in %.3f ms, %.0f records/s, scalar count_valid %.3f ms, %.0f records/s\n",
+        records, threads, parallel_ms, parallel_ms > 0 ? double(records) / parallel_ms * 1000 : 0.0,
+        scalar_ms, scalar_ms > 0 ? double(records) / scalar_ms * 1000 : 0.0);
+    return 0;
+}
+
 constexpr static char const* input =
 "byr:2024 iyr:2016\n"
 "eyr:2034 ecl:zzz pid:985592671 hcl:033b48\n"
@@ -1407,9 +1890,61 @@ constexpr static char const* input =
 "hgt:160cm hcl:#c0946f\n"
 "byr:1959\n";
 
-constexpr static auto valid_passports = count_valid(input);
+constexpr static auto count_valid_passports = [](auto const& str){ return count_valid(str); };
+
+#ifdef FIELD_DIAGNOSTICS
+/*
+ * Built with `-DFIELD_DIAGNOSTICS`, a day counts its input (the compiled one
+ * as well) through `FieldDiagnostics` and prints the histogram to stderr,
+ * followed by what keeping it costs: the best of a few counts in each mode
+ */
+template<typename Diagnostics>
+inline double best_ms(std::string_view text, std::size_t expected) noexcept{
+    auto best = 0.0;
+    for(std::size_t i = 0; i < 5; ++i){
+        auto start = std::chrono::steady_clock::now();
+        auto valid = count_valid_tokenized<Diagnostics>(text);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = (i == 0 || ms < best ? ms : best);
+        if(valid != expected){
+            std::fprintf(stderr, "count %lu differs from %lu\n", valid, expected);
+        }
+    }
+    return best;
+}
+
+inline int run_diagnostics(std::string_view text) noexcept{
+    auto valid = profile("count_valid_diagnostics", [&]{ return count_valid_tokenized<FieldDiagnostics>(text); });
+    std::printf("valid passports = %lu\n", valid);
+    FieldDiagnostics::report(stderr);
+    auto plain_ms = best_ms<NoDiagnostics>(text, valid);
+    auto diagnostics_ms = best_ms<FieldDiagnostics>(text, valid);
+    std::fprintf(stderr, "NoDiagnostics %.3f ms, FieldDiagnostics %.3f ms (%+.1f%%)\n",
+        plain_ms, diagnostics_ms, plain_ms > 0 ? (diagnostics_ms / plain_ms - 1) * 100 : 0.0);
+    return 0;
+}
+#endif
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+#ifdef FIELD_DIAGNOSTICS
+        return run_diagnostics(input->text());
+#endif
+        if(argc > 2){
+            return run_parallel_count(input->text(), input->data, std::size_t(std::strtoul(argv[2], nullptr, 10)));
+        }
+        auto valid = profile("count_valid_tokenized", [&]{ return count_valid_tokenized(input->text()); });
+        std::printf("valid passports = %lu\n", valid);
+        return 0;
+    }
+#ifdef FIELD_DIAGNOSTICS
+    return run_diagnostics(input);
+#endif
+    auto const& valid_passports = evaluate<input, count_valid_passports>();
     std::printf("valid passports = %lu\n", valid_passports);
     return 0;
 }
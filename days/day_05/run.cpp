@@ -2,54 +2,213 @@
 #include <cstdint>
 #include <experimental/array>
 #include <algorithm>
+#include <array>
 #include <limits>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
+/*
+ * Seat IDs - a plane of 2^row_bits rows of 2^col_bits seats has passes of
+ * row_bits + col_bits characters, rows first, and the ID of a seat (its row
+ * times 2^col_bits plus its column) is the binary number its pass spells,
+ * most significant character first
+ * 'B' and 'R' are exactly the letters with bit 2 clear ('F' and 'L' have it
+ * set), so every character gives its bit without being compared to anything
+ */
+constexpr std::size_t max_seat_bits = 32;
+
+using Seat = std::int64_t;
+
+constexpr auto seat_bit(char c) noexcept{
+    return Seat((~c >> 2) & 1);
+}
+
+template<std::size_t row_bits = 7, std::size_t col_bits = 3>
 constexpr auto get_seat(char const* str) noexcept{
-    std::int32_t row = 0b00000000;
-    for(std::size_t i = 0; i < 7; ++i){
-        auto bit = std::int32_t(str[i] == 'B');
-        row |= (bit << (6 - i));
-    }
-    std::int32_t col = 0b00000000;
-    for(std::size_t i = 0; i < 3; ++i){
-        auto bit = std::int32_t(str[i + 7] == 'R');
-        col |= (bit << (2 - i));
+    static_assert(row_bits + col_bits <= max_seat_bits, "seat IDs are at most 32 bits");
+    Seat seat = 0;
+    for(std::size_t i = 0; i < row_bits + col_bits; ++i){
+        seat = (seat << 1) | seat_bit(str[i]);
     }
-    return row * 8 + col;
+    return seat;
 }
 
-template<typename Array>
-constexpr auto get_highest_seat(Array const& array) noexcept{
-    std::int32_t seat = std::numeric_limits<std::int32_t>::min();
-    for(auto const& elem : array){
-        seat = std::max(seat, get_seat(elem));
+/*
+ * The same at runtime for any geometry, eight characters at a time - each
+ * eight are loaded as one word, byte swapped so that the first is the most
+ * significant, and bit 2 of every byte is gathered into one byte, by `pext`
+ * when built with BMI2 (`-mbmi2`) and by a multiply otherwise
+ * Only whole words inside the pass are loaded, the rest is done one by one
+ */
+inline Seat gather_eight(char const* str) noexcept{
+    auto word = __builtin_bswap64(load_eight(str));
+#if defined(__BMI2__)
+    auto bits = _pext_u64(word, 0x0404040404040404);
+#else
+    auto bits = (((word >> 2) & 0x0101010101010101) * 0x0102040810204080) >> 56;
+#endif
+    return Seat(~bits & 0xFF);
+}
+
+inline Seat decode_seat(char const* str, std::size_t seat_bits) noexcept{
+    Seat seat = 0;
+    std::size_t i = 0;
+    for(; i + 8 <= seat_bits; i += 8){
+        seat = (seat << 8) | gather_eight(str + i);
+    }
+    for(; i < seat_bits; ++i){
+        seat = (seat << 1) | seat_bit(str[i]);
     }
     return seat;
 }
 
-template<typename Array>
-constexpr auto get_lowest_seat(Array const& array) noexcept{
-    std::int32_t seat = std::numeric_limits<std::int32_t>::max();
-    for(auto const& elem : array){
-        seat = std::min(seat, get_seat(elem));
+// The geometry of the passes at runtime, read off the first of them
+struct Geometry{
+    std::size_t row_bits;
+    std::size_t col_bits;
+};
+
+inline Geometry detect_geometry(std::string_view text) noexcept{
+    auto geometry = Geometry{0, 0};
+    std::size_t i = 0;
+    for(; i < text.size() && (text[i] == 'F' || text[i] == 'B'); ++i){
+        ++geometry.row_bits;
     }
-    return seat;
+    for(; i < text.size() && (text[i] == 'L' || text[i] == 'R'); ++i){
+        ++geometry.col_bits;
+    }
+    return geometry;
 }
 
-template<auto highest_seat, auto lowest_seat, typename Array>
-constexpr auto get_my_seat(Array const& array) noexcept{
-    auto seen = std::array<bool, highest_seat + 1>{};
+/*
+ * Every pass is folded into running statistics as soon as it is decoded, so
+ * any number of them takes constant memory
+ * The seats run from the lowest to the highest, normally with one missing,
+ * and then the XOR of every ID in that range with the XOR of the seen ones
+ * leaves it
+ */
+struct Seats{
+    Seat lowest = std::numeric_limits<Seat>::max();
+    Seat highest = std::numeric_limits<Seat>::min();
+    Seat xor_sum = 0;
+    std::size_t count = 0;
+
+    constexpr void add(Seat seat) noexcept{
+        lowest = std::min(lowest, seat);
+        highest = std::max(highest, seat);
+        xor_sum ^= seat;
+        ++count;
+    }
+
+    constexpr bool one_missing() const noexcept{
+        return count > 0 && std::size_t(highest - lowest) == count;
+    }
+};
+
+// The XOR of every number from 0 to n, 0 for none
+constexpr Seat xor_upto(Seat n) noexcept{
+    switch(n & 3){
+        case 0: return n;
+        case 1: return 1;
+        case 2: return n + 1;
+        default: return 0;
+    }
+}
+
+constexpr Seat missing_seat(Seats const& seats) noexcept{
+    return xor_upto(seats.highest) ^ xor_upto(seats.lowest - 1) ^ seats.xor_sum;
+}
+
+/*
+ * Otherwise the taken seats are marked in a bitmap, and my seat is the first
+ * free one with both neighbours taken, found a word at a time
+ * `n` bits, seats at or past it all free, and `n` when there is none
+ */
+template<typename Words>
+constexpr std::size_t find_gap(Words const& words, std::size_t n) noexcept{
+    auto no_of_words = (n + 63) / 64;
+    for(std::size_t k = 0; k < no_of_words; ++k){
+        auto word = words[k];
+        auto before = (word << 1) | (k > 0 ? words[k - 1] >> 63 : 0);
+        auto after = (word >> 1) | (k + 1 < no_of_words ? words[k + 1] << 63 : 0);
+        auto gaps = ~word & before & after;
+        if(gaps != 0){
+            return k * 64 + std::size_t(__builtin_ctzll(gaps));
+        }
+    }
+    return n;
+}
+
+/*
+ * At compile time the bitmap covers every ID of the geometry, and is only
+ * filled in when the seats are not one short of their range
+ */
+template<std::size_t row_bits = 7, std::size_t col_bits = 3, typename Array>
+constexpr auto get_seats(Array const& array) noexcept{
+    auto seats = Seats{};
+    for(auto const& elem : array){
+        seats.add(get_seat<row_bits, col_bits>(elem));
+    }
+    if(seats.count == 0 || seats.one_missing()){
+        return std::make_tuple(seats.highest, seats.lowest, seats.count == 0 ? seats.highest : missing_seat(seats));
+    }
+    auto taken = std::array<std::uint64_t, ((std::size_t(1) << (row_bits + col_bits)) + 63) / 64>{};
     for(auto const& elem : array){
-        auto seat = get_seat(elem);
-        seen[seat] = true;
+        auto seat = std::size_t(get_seat<row_bits, col_bits>(elem));
+        taken[seat / 64] |= std::uint64_t(1) << (seat % 64);
     }
-    std::int32_t i = lowest_seat;
-    for(std::int32_t i = lowest_seat; i < highest_seat; ++i){
-        if(seen[i-1] && !seen[i] && seen[i+1]){
-            return i;
+    auto gap = find_gap(taken, std::size_t(seats.highest) + 1);
+    return std::make_tuple(seats.highest, seats.lowest, gap <= std::size_t(seats.highest) ? Seat(gap) : seats.highest);
+}
+
+/*
+ * At runtime straight from the text of the input, without indexing its
+ * lines - each pass is its first `seat_bits` characters, and anything after
+ * them up to the newline is skipped
+ */
+template<typename F>
+inline void for_each_seat(std::string_view text, std::size_t seat_bits, F&& f){
+    auto const* str = text.data();
+    auto const* end = str + text.size();
+    while(std::size_t(end - str) >= seat_bits && seat_bits > 0){
+        if(*str == '\n' || *str == '\r'){
+            ++str;
+            continue;
         }
+        f(decode_seat(str, seat_bits));
+        for(str += seat_bits; str != end && *str != '\n'; ++str);
+    }
+}
+
+inline Seats scan_seats(std::string_view text, std::size_t seat_bits) noexcept{
+    auto seats = Seats{};
+    for_each_seat(text, seat_bits, [&](Seat seat){
+        seats.add(seat);
+    });
+    return seats;
+}
+
+// Reading the passes a second time when needed, into a bitmap of the range
+inline Seat get_my_seat(std::string_view text, std::size_t seat_bits, Seats const& seats) noexcept{
+    if(seats.count == 0 || seats.one_missing()){
+        return seats.count == 0 ? seats.highest : missing_seat(seats);
     }
-    return highest_seat;
+    auto n = std::size_t(seats.highest - seats.lowest) + 1;
+    auto taken = std::vector<std::uint64_t>((n + 63) / 64);
+    for_each_seat(text, seat_bits, [&](Seat seat){
+        auto i = std::size_t(seat - seats.lowest);
+        taken[i / 64] |= std::uint64_t(1) << (i % 64);
+    });
+    auto gap = find_gap(taken, n);
+    return gap < n ? seats.lowest + Seat(gap) : seats.highest;
 }
 
 constexpr static auto input = std::experimental::make_array(
@@ -1020,13 +1179,31 @@ constexpr static auto input = std::experimental::make_array(
     "FFBFBFFLRL"
 );
 
-constexpr static auto highest_seat = get_highest_seat(input);
-constexpr static auto lowest_seat = get_lowest_seat(input);
-constexpr static auto my_seat = get_my_seat<highest_seat, lowest_seat>(input);
+constexpr static auto find_seats = [](auto const& array){ return get_seats(array); };
 
-int main(){
-    std::printf("highest seat = %d\n", highest_seat);
-    std::printf("lowest seat  = %d\n", lowest_seat);
-    std::printf("my seat      = %d\n", my_seat);
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto text = input->text();
+        auto geometry = detect_geometry(text);
+        auto seat_bits = geometry.row_bits + geometry.col_bits;
+        if(seat_bits == 0 || seat_bits > max_seat_bits){
+            std::fprintf(stderr, "passes of %lu row and %lu column characters are not supported\n", geometry.row_bits, geometry.col_bits);
+            return 1;
+        }
+        auto seats = profile("scan_seats", [&]{ return scan_seats(text, seat_bits); });
+        auto my_seat = profile("get_my_seat", [&]{ return get_my_seat(text, seat_bits, seats); });
+        std::printf("highest seat = %ld\n", seats.highest);
+        std::printf("lowest seat  = %ld\n", seats.lowest);
+        std::printf("my seat      = %ld\n", my_seat);
+        return 0;
+    }
+    auto const& [highest_seat, lowest_seat, my_seat] = evaluate<input, find_seats>();
+    std::printf("highest seat = %ld\n", highest_seat);
+    std::printf("lowest seat  = %ld\n", lowest_seat);
+    std::printf("my seat      = %ld\n", my_seat);
     return 0;
 }
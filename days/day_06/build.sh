@@ -1 +1 @@
-g++ -O3 -std=c++17 -ftemplate-depth=2300 -o run run.cpp
+g++ -O3 -std=c++17 -pthread -ftemplate-depth=2300 -o run run.cpp
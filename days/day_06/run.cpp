@@ -1,57 +1,224 @@
+#include <chrono>
 #include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <array>
 #include <experimental/array>
+#include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/pool.hpp"
+#include "../common/profile.hpp"
+#include "../common/records.hpp"
+#include "../common/evaluate.hpp"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-template<typename Array>
-constexpr void answer_form(Array& form, char const* str) noexcept{
+template<std::size_t size>
+using CharConstPtr = char const (&)[size];
+
+/*
+ * Alphabets - the symbols a form can be answered with, at most 64 of them,
+ * each given one bit of a mask in the order they are listed
+ * When they are a single run of characters (as 'a' to 'z' are) long lines
+ * can also be reduced with AVX2, see `line_mask`
+ */
+constexpr std::size_t max_symbols = 64;
+
+struct Alphabet{
+    std::array<std::uint64_t, 256> bits;  // the bit of every symbol, 0 for any other character
+    std::size_t size;
+    std::uint8_t first;
+    bool contiguous;
+};
+
+template<std::size_t size>
+constexpr auto make_alphabet(CharConstPtr<size> symbols) noexcept{
+    static_assert(size - 1 <= max_symbols, "at most 64 symbols");
+    auto alphabet = Alphabet{{}, size - 1, std::uint8_t(symbols[0]), true};
+    for(std::size_t i = 0; i < size - 1; ++i){
+        alphabet.bits[std::uint8_t(symbols[i])] = std::uint64_t(1) << i;
+        alphabet.contiguous &= (std::uint8_t(symbols[i]) == alphabet.first + i);
+    }
+    return alphabet;
+}
+
+constexpr static auto letters = make_alphabet("abcdefghijklmnopqrstuvwxyz");
+
+/*
+ * A line of answers reduced to the mask of the symbols in it, anything else
+ * in it ignored
+ */
+constexpr std::uint64_t line_mask(Alphabet const& alphabet, char const* str) noexcept{
+    std::uint64_t mask = 0;
     for(; *str != '\0'; ++str){
-        form[*str - 'a'] += 1;
+        mask |= alphabet.bits[std::uint8_t(*str)];
     }
+    return mask;
 }
 
-template<auto f, typename Array>
-constexpr auto count_form(Array const& form, std::size_t s) noexcept{
-    std::size_t n = 0;
-    for(auto answer : form){
-        n += f(answer, s);
+/*
+ * The same for a line of known length at runtime, where with AVX2 a line of
+ * 32 or more characters over a run of at most 32 symbols is done 8 at a
+ * time, each character shifting a 1 into place by how far it is past the
+ * first symbol (`vpsllv` gives 0 for anything outside the run)
+ */
+inline std::uint64_t line_mask(Alphabet const& alphabet, char const* str, std::size_t length) noexcept{
+    std::uint64_t mask = 0;
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    if(alphabet.contiguous && alphabet.size <= 32 && length >= 32){
+        auto first = _mm256_set1_epi32(alphabet.first);
+        auto one = _mm256_set1_epi32(1);
+        auto bits = _mm256_setzero_si256();
+        for(; i + 8 <= length; i += 8){
+            auto chars = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(str + i)));
+            bits = _mm256_or_si256(bits, _mm256_sllv_epi32(one, _mm256_sub_epi32(chars, first)));
+        }
+        auto folded = _mm_or_si128(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+        folded = _mm_or_si128(folded, _mm_shuffle_epi32(folded, 0x4E));
+        folded = _mm_or_si128(folded, _mm_shuffle_epi32(folded, 0xB1));
+        auto in_alphabet = (alphabet.size == 32 ? ~std::uint32_t(0) : (std::uint32_t(1) << alphabet.size) - 1);
+        mask = std::uint32_t(_mm_cvtsi128_si32(folded)) & in_alphabet;
     }
-    return n;
+#endif
+    for(; i < length; ++i){
+        mask |= alphabet.bits[std::uint8_t(str[i])];
+    }
+    return mask;
 }
 
-// Count anyone
+/*
+ * Groups - the symbols anyone in a group answered are the OR of its masks,
+ * those everyone answered the AND, and each adds their popcounts
+ */
+struct Group{
+    std::uint64_t anyone = 0;
+    std::uint64_t everyone = ~std::uint64_t(0);
+    std::size_t people = 0;
 
-constexpr auto anyone(std::size_t answer, std::size_t) noexcept{
-    return answer > 0;
-}
+    constexpr void add(std::uint64_t mask) noexcept{
+        anyone |= mask;
+        everyone &= mask;
+        ++people;
+    }
+};
 
-// Count everyone
+struct Counts{
+    std::size_t anyone = 0;
+    std::size_t everyone = 0;
 
-constexpr auto everyone(std::size_t answer, std::size_t s) noexcept{
-    return answer == s;
-}
+    // A group of no one, between two blank lines in a row, adds nothing
+    constexpr void add(Group const& group) noexcept{
+        anyone += std::size_t(__builtin_popcountll(group.anyone));
+        everyone += (group.people > 0 ? std::size_t(__builtin_popcountll(group.everyone)) : 0);
+    }
+};
 
-// Altogether
+// Altogether, with empty lines separating the groups
 
-template<auto f, auto g, typename Array>
-constexpr auto count_answers(Array const& array) noexcept{
-    constexpr auto size = std::size_t('z' - 'a') + 1;
-    auto form = std::array<std::size_t, size>{};
-    std::size_t n = 0;
-    std::size_t m = 0;
-    std::size_t s = 0;
+template<typename Array>
+constexpr auto count_answers(Array const& array, Alphabet const& alphabet = letters) noexcept{
+    auto counts = Counts{};
+    auto group = Group{};
     for(auto line : array){
         if(*line == '\0'){
-            n += count_form<f>(form, s);
-            m += count_form<g>(form, s);
-            form = std::array<std::size_t, size>{};
-            s = 0;
+            counts.add(group);
+            group = Group{};
         } else{
-            answer_form(form, line);
-            ++s;
+            group.add(line_mask(alphabet, line));
         }
     }
-    n += count_form<f>(form, s);
-    m += count_form<g>(form, s);
-    return std::experimental::make_array(n, m);
+    counts.add(group);
+    return std::experimental::make_array(counts.anyone, counts.everyone);
+}
+
+/*
+ * Straight from the text of the input at runtime, without indexing its
+ * lines - a trailing newline does not start another group, as with the
+ * line index
+ */
+inline Counts count_answers(std::string_view text, Alphabet const& alphabet = letters) noexcept{
+    auto counts = Counts{};
+    auto group = Group{};
+    auto const* str = text.data();
+    auto const* end = str + text.size();
+    while(str != end){
+        auto const* newline = static_cast<char const*>(std::memchr(str, '\n', std::size_t(end - str)));
+        auto const* line_end = (newline ? newline : end);
+        auto length = std::size_t(line_end - str);
+        if(length > 0 && str[length - 1] == '\r'){
+            --length;
+        }
+        if(length == 0){
+            counts.add(group);
+            group = Group{};
+        } else{
+            group.add(line_mask(alphabet, str, length));
+        }
+        str = (newline ? newline + 1 : end);
+    }
+    counts.add(group);
+    return counts;
+}
+
+/*
+ * Parallel counting - the text is cut into chunks of about `chunk_bytes` at
+ * blank lines, so that every group lies whole in one chunk, and each thread
+ * (0 for one per core) adds up the counts of the chunks it takes in its own
+ * cache line, the threads' counts only being added together at the end
+ */
+constexpr std::size_t chunk_bytes = std::size_t(1) << 18;
+
+struct alignas(64) ThreadCounts{
+    Counts counts;
+};
+
+inline Counts count_answers_parallel(std::string_view text, std::size_t threads, Alphabet const& alphabet = letters) noexcept{
+    auto chunks = split_records(text, chunk_bytes);
+    threads = (threads == 0 ? default_threads() : threads);
+    auto partial = std::vector<ThreadCounts>(threads);
+    run_parallel(chunks.size(), threads, [&](std::size_t chunk, std::size_t thread){
+        auto counts = count_answers(chunks[chunk], alphabet);
+        partial[thread].counts.anyone += counts.anyone;
+        partial[thread].counts.everyone += counts.everyone;
+    });
+    auto counts = Counts{};
+    for(auto const& thread_counts : partial){
+        counts.anyone += thread_counts.counts.anyone;
+        counts.everyone += thread_counts.counts.everyone;
+    }
+    return counts;
+}
+
+/*
+ * Report the sums, and to stderr the throughput of the parallel count
+ * against `count_answers` on one thread over the same text, which it has to
+ * agree with
+ * The single threaded count goes first, also reading in the whole mapping
+ */
+inline int run_parallel_count(std::string_view text, std::size_t threads) noexcept{
+    threads = (threads == 0 ? default_threads() : threads);
+    auto start = std::chrono::steady_clock::now();
+    auto expected = profile("count_answers", [&]{ return count_answers(text); });
+    auto single = std::chrono::steady_clock::now();
+    auto counts = profile("count_answers_parallel", [&]{ return count_answers_parallel(text, threads); });
+    auto parallel = std::chrono::steady_clock::now();
+    if(counts.anyone != expected.anyone || counts.everyone != expected.everyone){
+        std::fprintf(stderr, "parallel sums %lu, %lu differ from %lu, %lu\n", counts.anyone, counts.everyone, expected.anyone, expected.everyone);
+        return 1;
+    }
+    std::printf("sum of anyone   = %lu\n", counts.anyone);
+    std::printf("sum of everyone = %lu\n", counts.everyone);
+    auto single_ms = std::chrono::duration<double, std::milli>(single - start).count();
+    auto parallel_ms = std::chrono::duration<double, std::milli>(parallel - single).count();
+    auto megabytes = double(text.size()) / 1e6;
+    std::fprintf(stderr, "%.1f MB on %lu threads in %.3f ms, %.0f MB/s, count_answers %.3f ms, %.0f MB/s, speedup %.2f\n",
+        megabytes, threads, parallel_ms, parallel_ms > 0 ? megabytes / parallel_ms * 1000 : 0.0,
+        single_ms, single_ms > 0 ? megabytes / single_ms * 1000 : 0.0, parallel_ms > 0 ? single_ms / parallel_ms : 0.0);
+    return 0;
 }
 
 constexpr static auto test_input = std::experimental::make_array(
@@ -2358,9 +2525,23 @@ constexpr static auto input = std::experimental::make_array(
     "jtiunkpsroa"
 );
 
-constexpr static auto sum_of_counts = count_answers<anyone, everyone>(input);
+constexpr static auto count_all_answers = [](auto const& array){ return count_answers(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        if(argc > 2){
+            return run_parallel_count(input->text(), std::size_t(std::strtoul(argv[2], nullptr, 10)));
+        }
+        auto counts = profile("count_answers", [&]{ return count_answers(input->text()); });
+        std::printf("sum of anyone   = %lu\n", counts.anyone);
+        std::printf("sum of everyone = %lu\n", counts.everyone);
+        return 0;
+    }
+    auto const& sum_of_counts = evaluate<input, count_all_answers>();
     std::printf("sum of anyone   = %lu\n", std::get<0>(sum_of_counts));
     std::printf("sum of everyone = %lu\n", std::get<1>(sum_of_counts));
     return 0;
@@ -2,6 +2,11 @@
 #include <tuple>
 #include <experimental/array>
 #include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
@@ -24,25 +29,6 @@ struct Child{
     std::size_t child;
 };
 
-constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
-    std::int32_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 template<std::size_t size>
 constexpr auto split(std::string_view view, CharConstPtr<size> match) noexcept{
     auto pos = view.find(match);
@@ -64,14 +50,15 @@ constexpr auto split(std::string_view view, CharConstPtr<size> match) noexcept{
  *            an "alternative" to a compile-time map,
  *            assuming this will be fast enough
  */
-template<std::size_t size>
-constexpr auto make_register(std::array<char const*, size> const& array) noexcept{
-    return std::apply([](auto const*... strs){
-        return std::experimental::make_array([](auto const* str){
-            auto view = std::get<0>(split(str, " contain "));
-            return std::string_view{view.data(), view.size() - 5};
-        }(strs)...);
-    }, array);
+template<typename Array>
+constexpr auto make_register(Array const& array) noexcept{
+    auto r = storage_for<std::string_view>(array);
+    std::size_t i = 0;
+    for(auto const* str : array){
+        auto view = std::get<0>(split(str, " contain "));
+        r[i++] = std::string_view{view.data(), view.size() - 5};
+    }
+    return r;
 }
 
 /*
@@ -111,11 +98,11 @@ constexpr auto parse_bags(Array const& r, std::string_view view) noexcept{
  * - graph mapping parent colours -> child colours (each bag -> bags inside this bag)
  * - graph mapping child colours -> parent colours (each bag -> bags that have this bag inside)
  */
-template<std::size_t size>
-constexpr auto make_graphs(std::array<char const*, size> const& array) noexcept{
+template<typename Array>
+constexpr auto make_graphs(Array const& array) noexcept{
     auto r = make_register(array);
-    auto c_to_p_graph = std::array<std::array<Parent, 32>, size>{}; // "compile-time list" of size 32 is good enough
-    auto p_to_c_graph = std::array<std::array<Child, 4>, size>{};   // "compile-time list" of size 4 is good enough
+    auto c_to_p_graph = storage_for<std::array<Parent, 32>>(array); // "compile-time list" of size 32 is good enough
+    auto p_to_c_graph = storage_for<std::array<Child, 4>>(array);   // "compile-time list" of size 4 is good enough
     std::size_t i = 0;
     for(auto const* line : array){
         auto str = std::get<1>(split(line, " contain "));
@@ -164,14 +151,14 @@ constexpr std::size_t search_children(Graph const& graph, std::size_t colour) no
 
 // Altogether
 
-template<std::size_t size>
-constexpr auto search(std::array<char const*, size> const& array, std::string_view view) noexcept{
+template<typename Array>
+constexpr auto search(Array const& array, std::string_view view) noexcept{
     auto [r, c_to_p_graph, p_to_c_graph] = make_graphs(array);
     auto colour = find_in_register(r, view);
 
     // Part 1
     // using a "compile-time set" to avoid duplicates during recursion
-    auto set = std::array<bool, size>{};
+    auto set = storage_for<bool>(array);
     search_parents(c_to_p_graph, set, colour);
     std::size_t n = 0;
     for(auto x : set){
@@ -804,9 +791,21 @@ constexpr static auto input = std::experimental::make_array(
     "clear brown bags contain no other bags."
 );
 
-constexpr static auto answer = search(input, "shiny gold");
+constexpr static auto search_shiny_gold = [](auto const& array){ return search(array, "shiny gold"); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto answer = profile("search", [&]{ return search(lines, "shiny gold"); });
+        std::printf("bag colours that can contain one shiny gold bag = %lu\n", std::get<0>(answer));
+        std::printf("bag colours required inside one shiny gold bag  = %lu\n", std::get<1>(answer));
+        return 0;
+    }
+    auto const& answer = evaluate<input, search_shiny_gold>();
     std::printf("bag colours that can contain one shiny gold bag = %lu\n", std::get<0>(answer));
     std::printf("bag colours required inside one shiny gold bag  = %lu\n", std::get<1>(answer));
     return 0;
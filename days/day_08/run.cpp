@@ -2,6 +2,11 @@
 #include <tuple>
 #include <experimental/array>
 #include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 enum class Op{
     nop,
@@ -14,31 +19,11 @@ struct Instruction{
     std::int32_t arg;
 };
 
-constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
-    std::int32_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 ///////////////////////
 
 constexpr auto parse_instruction(char const* str) noexcept{
     auto inst = std::string_view{str, 3};
-    auto sign = std::int32_t(*(str + 4) == '-' ? -1 : 1);
-    auto arg =  sign * str_to_int(str + 5, nullptr);
+    auto arg = str_to_signed<std::int32_t>(str + 4, nullptr);
     return Instruction{
         inst == std::string_view{"acc"} ? Op::acc :
         inst == std::string_view{"jmp"} ? Op::jmp :
@@ -47,20 +32,23 @@ constexpr auto parse_instruction(char const* str) noexcept{
     };
 }
 
-template<std::size_t size>
-constexpr auto read_boot_code(std::array<char const*, size> const& array) noexcept{
-    return std::apply([](auto const*... strs){
-        return std::experimental::make_array(parse_instruction(strs)...);
-    }, array);
+template<typename Array>
+constexpr auto read_boot_code(Array const& array) noexcept{
+    auto boot_code = storage_for<Instruction>(array);
+    std::size_t i = 0;
+    for(auto const* str : array){
+        boot_code[i++] = parse_instruction(str);
+    }
+    return boot_code;
 }
 
-template<std::size_t size>
-constexpr auto run(std::array<Instruction, size> const& boot_code) noexcept{
-    auto set = std::array<bool, size>{};
+template<typename BootCode>
+constexpr auto run(BootCode const& boot_code) noexcept{
+    auto set = storage_for<bool>(boot_code);
     std::int32_t acc = 0;
     std::size_t i = 0;
     bool is_finite = true;
-    while(i < size){
+    while(i < boot_code.size()){
         if(set[i]){
             is_finite = false;
             break;
@@ -86,8 +74,8 @@ constexpr auto run(std::array<Instruction, size> const& boot_code) noexcept{
     return std::make_tuple(is_finite, acc);
 }
 
-template<std::size_t size>
-constexpr auto fix_and_run(std::array<Instruction, size> const& boot_code) noexcept{
+template<typename BootCode>
+constexpr auto fix_and_run(BootCode const& boot_code) noexcept{
     std::size_t i = 0;
     for(auto const& inst : boot_code){
         if(inst.op == Op::acc){
@@ -755,11 +743,25 @@ constexpr static auto input = std::experimental::make_array(
     "jmp +1"
 );
 
-constexpr static auto boot_code = read_boot_code(input);
-constexpr static auto old_value = std::get<1>(run(boot_code));
-constexpr static auto new_value = std::get<1>(fix_and_run(boot_code));
+constexpr static auto run_boot_code = [](auto const& array){
+    auto boot_code = read_boot_code(array);
+    return std::make_tuple(std::get<1>(run(boot_code)), std::get<1>(fix_and_run(boot_code)));
+};
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto boot_code = profile("read_boot_code", [&]{ return read_boot_code(c_strs(index_lines(*input))); });
+        auto broken = profile("run", [&]{ return run(boot_code); });
+        auto fixed = profile("fix_and_run", [&]{ return fix_and_run(boot_code); });
+        std::printf("value from broken code loop = %d\n", std::get<1>(broken));
+        std::printf("value from fixed code loop  = %d\n", std::get<1>(fixed));
+        return 0;
+    }
+    auto const& [old_value, new_value] = evaluate<input, run_boot_code>();
     std::printf("value from broken code loop = %d\n", old_value);
     std::printf("value from fixed code loop  = %d\n", new_value);
     return 0;
@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <tuple>
 #include <algorithm>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
 
 constexpr static std::size_t preamble = 25;
 
@@ -90,6 +94,55 @@ constexpr auto find_first_number_and_weakness() noexcept{
     return helper_for_weakness<std::get<0>(result), std::get<1>(result), value>::template find_weakness<rest...>();
 }
 
+// Any array of numbers
+//
+// The same searches as above, but over an array instead of a template
+// parameter pack, so they can be given an input read at runtime
+
+template<typename Array>
+constexpr auto find_first_number(Array const& array) noexcept{
+    for(std::size_t index = preamble; index < array.size(); ++index){
+        auto value = array[index];
+        bool found = false;
+        for(std::size_t i = index - preamble; i < index && !found; ++i){
+            for(std::size_t j = i + 1; j < index; ++j){
+                if(array[i] + array[j] == value){
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if(!found){
+            return std::make_tuple(index, value);
+        }
+    }
+    return std::make_tuple(array.size(), std::uint64_t{0});
+}
+
+template<typename Array>
+constexpr auto find_weakness(Array const& array, std::size_t index, std::uint64_t number) noexcept{
+    for(std::size_t i = 0; i < index; ++i){
+        auto sum = array[i];
+        auto min = array[i];
+        auto max = array[i];
+        for(std::size_t j = i + 1; j < index && sum < number; ++j){
+            sum += array[j];
+            min = std::min(min, array[j]);
+            max = std::max(max, array[j]);
+            if(sum == number){
+                return min + max;
+            }
+        }
+    }
+    return std::uint64_t{0};
+}
+
+template<typename Array>
+constexpr auto find_first_number_and_weakness(Array const& array) noexcept{
+    auto [index, number] = find_first_number(array);
+    return std::make_tuple(number, find_weakness(array, index, number));
+}
+
 constexpr static auto answer = find_first_number_and_weakness<
     8,
     11,
@@ -1093,7 +1146,18 @@ constexpr static auto answer = find_first_number_and_weakness<
     70006357515771
 >();
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto numbers = profile("parse_integers", [&]{ return parse_integers<std::uint64_t>(input->text()); });
+        auto answer = profile("find_first_number_and_weakness", [&]{ return find_first_number_and_weakness(numbers); });
+        std::printf("first number without property    = %lu\n", std::get<0>(answer));
+        std::printf("first number encryption weakness = %lu\n", std::get<1>(answer));
+        return 0;
+    }
     std::printf("first number without property    = %lu\n", std::get<0>(answer));
     std::printf("first number encryption weakness = %lu\n", std::get<1>(answer));
     return 0;
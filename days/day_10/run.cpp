@@ -1,11 +1,17 @@
 #include <cstdio>
 #include <experimental/array>
 #include <algorithm>
-#include <limits>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
-template<typename T, std::size_t size>
-constexpr auto max(std::array<T, size> const& array) noexcept{
-    auto m = std::numeric_limits<T>::min();
+template<typename Array>
+constexpr auto max(Array const& array) noexcept{
+    using T = typename Array::value_type;
+    // Never below the outlet's 0, so that no adapters at all is still a chain
+    auto m = T{0};
     for(auto const& elem : array){
         m = std::max(m, elem);
     }
@@ -19,8 +25,8 @@ constexpr void swap(T& a, T& b) noexcept{
     b = tmp;
 }
 
-template<typename T, std::size_t size>
-constexpr auto sort_impl(std::array<T, size>& array, std::size_t low, std::size_t high) noexcept{
+template<typename Array>
+constexpr auto sort_impl(Array& array, std::size_t low, std::size_t high) noexcept{
     auto pivot = array[high];
     std::size_t i = low;
     for(std::size_t j = low; j <= high; ++j){
@@ -33,21 +39,31 @@ constexpr auto sort_impl(std::array<T, size>& array, std::size_t low, std::size_
     return i;
 }
 
-template<typename T, std::size_t size>
-constexpr void sort(std::array<T, size>& array, std::size_t low=0, std::size_t high=size-1) noexcept{
+template<typename Array>
+constexpr void sort(Array& array, std::size_t low, std::size_t high) noexcept{
     if(low < high){
         auto pivot = sort_impl(array, low, high);
-        sort(array, low, pivot - 1);
+        if(pivot > low){
+            sort(array, low, pivot - 1);
+        }
         sort(array, pivot + 1, high);
     }
 }
 
-template<typename T, std::size_t size>
-constexpr auto find_differences(std::array<T, size> array) noexcept{
+template<typename Array>
+constexpr void sort(Array& array) noexcept{
+    if(array.size() > 0){
+        sort(array, 0, array.size() - 1);
+    }
+}
+
+template<typename Array>
+constexpr auto find_differences(Array array) noexcept{
+    using T = typename Array::value_type;
     sort(array);
     auto differences = std::array<std::size_t, 3>{};
     T start = 0;
-    for(std::size_t i = 0; i < size; ++i){
+    for(std::size_t i = 0; i < array.size(); ++i){
         auto left = (i == 0 ? start : array[i - 1]);
         auto right = array[i];
         auto difference = right - left;
@@ -58,19 +74,16 @@ constexpr auto find_differences(std::array<T, size> array) noexcept{
 }
 
 
-template<auto max, typename T, std::size_t size>
-constexpr auto find_arrangements(std::array<T, size> array) noexcept{
+template<typename Arrangements, typename Array>
+constexpr auto find_arrangements_impl(Array array, Arrangements& arrangements) noexcept{
+    using T = typename Array::value_type;
     sort(array);
-    auto arrangements = std::array<std::size_t, max + 4>{};
-    arrangements[max + 3] = 1;
-    for(std::size_t i = size - 1; i >= 0; --i){
+    arrangements[arrangements.size() - 1] = 1;
+    for(auto i = array.size(); i-- > 0;){
         auto elem = array[i];
         for(T j = 1; j <= 3; ++j){
             arrangements[elem] += arrangements[elem + j];
         }
-        if(i == 0){
-            break;
-        }
     }
     auto elem = 0;
     for(T j = 1; j <= 3; ++j){
@@ -79,6 +92,20 @@ constexpr auto find_arrangements(std::array<T, size> array) noexcept{
     return arrangements[0];
 }
 
+template<auto max, typename Array>
+constexpr auto find_arrangements(Array const& array) noexcept{
+    auto arrangements = std::array<std::size_t, max + 4>{};
+    return find_arrangements_impl(array, arrangements);
+}
+
+// The same, but with the highest joltage only known at runtime
+
+template<typename Array>
+inline auto find_arrangements(Array const& array) noexcept{
+    auto arrangements = std::vector<std::size_t>(std::size_t(max(array)) + 4);
+    return find_arrangements_impl(array, arrangements);
+}
+
 constexpr static auto test_input = std::experimental::make_array(
     16,
     10,
@@ -224,15 +251,31 @@ constexpr static auto input = std::experimental::make_array(
     66
 );
 
-constexpr static auto differences = find_differences(input);
-constexpr static auto arrangements = find_arrangements<max(input)>(input);
-constexpr static auto answer = std::get<0>(differences) * std::get<2>(differences);
+constexpr static auto find_all_differences = [](auto const& array){ return find_differences(array); };
+constexpr static auto find_all_arrangements = [](auto const& array){ return find_arrangements<max(input)>(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto joltages = profile("parse_integers", [&]{ return parse_integers<std::int32_t>(input->text()); });
+        auto differences = profile("find_differences", [&]{ return find_differences(joltages); });
+        auto arrangements = profile("find_arrangements", [&]{ return find_arrangements(joltages); });
+        std::printf("1-volt difference = %lu\n", std::get<0>(differences));
+        std::printf("2-volt difference = %lu\n", std::get<1>(differences));
+        std::printf("3-volt difference = %lu\n", std::get<2>(differences));
+        std::printf("1-volt * 3-volt   = %lu\n", std::get<0>(differences) * std::get<2>(differences));
+        std::printf("arrangements      = %lu\n", arrangements);
+        return 0;
+    }
+    auto const& differences = evaluate<input, find_all_differences>();
+    auto const& arrangements = evaluate<input, find_all_arrangements>();
     std::printf("1-volt difference = %lu\n", std::get<0>(differences));
     std::printf("2-volt difference = %lu\n", std::get<1>(differences));
     std::printf("3-volt difference = %lu\n", std::get<2>(differences));
-    std::printf("1-volt * 3-volt   = %lu\n", answer);
+    std::printf("1-volt * 3-volt   = %lu\n", std::get<0>(differences) * std::get<2>(differences));
     std::printf("arrangements      = %lu\n", arrangements);
     return 0;
 }
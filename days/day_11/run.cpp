@@ -1,5 +1,10 @@
 #include <cstdio>
 #include <experimental/array>
+#include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
@@ -48,6 +53,43 @@ constexpr auto make_grid(CharConstPtr<size> value, Ts&&... values) noexcept{
     }(value, std::forward<Ts>(values)...)};
 }
 
+/*
+ * Grid read at runtime - the same members, but
+ * only known once the input has been indexed
+ */
+template<>
+struct Grid<std::string_view, 0>{
+    std::size_t no_of_rows;
+    std::size_t no_of_cols;
+
+    std::vector<std::vector<char>> array;
+
+    auto& operator[](std::size_t index) noexcept{
+        return array[index];
+    }
+
+    auto const& operator[](std::size_t index) const noexcept{
+        return array[index];
+    }
+
+    bool operator==(Grid const& that) const noexcept{
+        return this->array == that.array;
+    }
+
+    bool operator!=(Grid const& that) const noexcept{
+        return !(*this == that);
+    }
+};
+
+inline auto make_grid(std::vector<std::string_view> const& lines) noexcept{
+    auto no_of_cols = (lines.empty() ? 0 : lines[0].size());
+    auto grid = Grid<std::string_view, 0>{lines.size(), no_of_cols, {}};
+    for(auto line : lines){
+        grid.array.emplace_back(line.begin(), line.end());
+    }
+    return grid;
+}
+
 template<typename G>
 constexpr void print_grid(G const& grid) noexcept{
     for(std::size_t i = 0; i < grid.no_of_rows; ++i){
@@ -87,8 +129,8 @@ constexpr auto get_next_seat(G const& grid, std::ptrdiff_t i, std::ptrdiff_t j)
             std::ptrdiff_t a = i + s * x;
             std::ptrdiff_t b = j + s * y;
             while(
-                0 <= a && a < G::no_of_rows &&
-                0 <= b && b < G::no_of_cols
+                0 <= a && a < grid.no_of_rows &&
+                0 <= b && b < grid.no_of_cols
             ){
                 occupied += (grid[a][b] == '#');
                 auto condition = (grid[i][j] == 'L' && occupied > 0) ||
@@ -237,9 +279,20 @@ constexpr static auto input = make_grid(
     "LLLLLLL.LLLLLLLLLLLL..LLL.LLLLLLLL..LLLLLLLLLLLLLL.LLLLLLLLLLL.LLLLLLL.LLLLLLLL.LLLLLLL.LLLLL"
 );
 
-constexpr static auto count = whac_a_mole<true, 5>(input);
+constexpr static auto seats_occupied = [](auto const& grid){ return whac_a_mole<true, 5>(grid); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto grid = profile("make_grid", [&]{ return make_grid(index_lines(*input)); });
+        auto count = profile("whac_a_mole", [&]{ return whac_a_mole<true, 5>(grid); });
+        std::printf("seats occupied = %lu\n", count);
+        return 0;
+    }
+    auto const& count = evaluate<input, seats_occupied>();
     std::printf("seats occupied = %lu\n", count);
     return 0;
 }
@@ -1,5 +1,9 @@
 #include <cstdio>
 #include <experimental/array>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 struct Instruction{
     char action;
@@ -8,25 +12,6 @@ struct Instruction{
 
 using Point = std::array<std::int32_t, 2>;
 
-constexpr std::int32_t str_to_int(char const* str, char const** endptr) noexcept{
-    std::int32_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 template<typename T>
 constexpr auto abs(T t) noexcept{
     return t >= 0 ? t : -t;
@@ -861,11 +846,25 @@ constexpr static auto input = std::experimental::make_array(
     "F47"
 );
 
-constexpr static auto incorrect_distance = navigate<false>(input, std::experimental::make_array(1, 0));
-constexpr static auto correct_distance = navigate<true>(input, std::experimental::make_array(10, 1));
+constexpr static auto incorrect_distance = [](auto const& array){ return navigate<false>(array, std::experimental::make_array(1, 0)); };
+constexpr static auto correct_distance = [](auto const& array){ return navigate<true>(array, std::experimental::make_array(10, 1)); };
 
-int main(){
-    std::printf("incorrect distance = %d\n", incorrect_distance);
-    std::printf("correct distance   = %d\n", correct_distance);
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto incorrect = profile("navigate<false>", [&]{ return navigate<false>(lines, std::experimental::make_array(1, 0)); });
+        auto correct = profile("navigate<true>", [&]{ return navigate<true>(lines, std::experimental::make_array(10, 1)); });
+        std::printf("incorrect distance = %d\n", incorrect);
+        std::printf("correct distance   = %d\n", correct);
+        return 0;
+    }
+    auto const& incorrect = evaluate<input, incorrect_distance>();
+    auto const& correct = evaluate<input, correct_distance>();
+    std::printf("incorrect distance = %d\n", incorrect);
+    std::printf("correct distance   = %d\n", correct);
     return 0;
 }
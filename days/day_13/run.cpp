@@ -1,24 +1,9 @@
 #include <cstdio>
 #include <experimental/array>
-
-constexpr std::size_t str_to_size_t(char const* str, char const** endptr) noexcept{
-    std::size_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 constexpr auto get_timetable(char const* str) noexcept{
     auto bus_ids = std::array<std::size_t, 200>{};
@@ -118,10 +103,24 @@ constexpr static auto input = std::experimental::make_array(
     "29,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,41,x,x,x,x,x,x,x,x,x,661,x,x,x,x,x,x,x,x,x,x,x,x,13,17,x,x,x,x,x,x,x,x,23,x,x,x,x,x,x,x,521,x,x,x,x,x,37,x,x,x,x,x,x,x,x,x,x,x,x,19"
 );
 
-constexpr static auto bus_mul_min = find_bus_mul_min(input);
-constexpr static auto earliest_timestamp = find_earliest_timestamp(input);
+constexpr static auto find_first_bus = [](auto const& array){ return find_bus_mul_min(array); };
+constexpr static auto find_timestamp = [](auto const& array){ return find_earliest_timestamp(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto bus_mul_min = profile("find_bus_mul_min", [&]{ return find_bus_mul_min(lines); });
+        auto timestamp = profile("find_earliest_timestamp", [&]{ return find_earliest_timestamp(lines); });
+        std::printf("bus ID * mins      = %lu\n", bus_mul_min);
+        std::printf("earliest_timestamp = %lu\n", timestamp);
+        return 0;
+    }
+    auto const& bus_mul_min = evaluate<input, find_first_bus>();
+    auto const& earliest_timestamp = evaluate<input, find_timestamp>();
     std::printf("bus ID * mins      = %lu\n", bus_mul_min);
     std::printf("earliest_timestamp = %lu\n", earliest_timestamp);
     return 0;
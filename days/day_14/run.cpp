@@ -2,6 +2,12 @@
 #include <string_view>
 #include <experimental/array>
 #include <limits>
+#include <optional>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/scratch.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 /*
  * This map is tailored to the input, as we happen to
@@ -22,6 +28,7 @@ struct TailoredMap{
             }
             ++i;
         }
+        full = true;
         return end;
     }
     constexpr auto const& operator[](std::size_t key) const noexcept{
@@ -32,29 +39,18 @@ struct TailoredMap{
         }
         return end;
     }
+    constexpr void clear() noexcept{
+        for(auto& row : map){
+            row.fill({});
+        }
+        end = 0;
+        full = false;
+    }
     std::size_t end = 0;
+    bool full = false;  // a key found its bucket full, and was written to `end`
     std::array<std::array<std::array<std::size_t, 2>, 30>, 4759> map{};
 };
 
-constexpr std::size_t str_to_size_t(char const* str, char const** endptr) noexcept{
-    std::size_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 /*
  * From this we can tell how many 0s, 1s, and Xs were in the mask, and where
  */
@@ -119,9 +115,8 @@ constexpr void decode(TailoredMap& memory, std::array<std::size_t, 2> const& mem
 // Altogether
 
 template<auto f, typename Array>
-constexpr auto memory_sum(Array const& array) noexcept{
+constexpr auto memory_sum(Array const& array, TailoredMap& map) noexcept{
     auto mask_info = std::array<std::size_t, 2>{};
-    auto map = TailoredMap{};
     for(auto const* line : array){
         if(std::string_view{line, 3} == std::string_view{"mas"}){
             // mask
@@ -141,6 +136,28 @@ constexpr auto memory_sum(Array const& array) noexcept{
     return sum;
 }
 
+template<auto f, typename Array>
+constexpr auto memory_sum(Array const& array) noexcept{
+    auto map = TailoredMap{};
+    return memory_sum<f>(array, map);
+}
+
+/*
+ * At runtime the map is reused, as it is too large to want on the stack,
+ * and an input writing more addresses than it holds has no sum rather than
+ * a wrong one
+ */
+template<auto f, typename Array>
+inline std::optional<std::size_t> memory_sum_reusing(Array const& array) noexcept{
+    auto& map = scratch<TailoredMap>();
+    map.clear();
+    auto sum = memory_sum<f>(array, map);
+    if(map.full){
+        return std::nullopt;
+    }
+    return sum;
+}
+
 constexpr static auto input = std::experimental::make_array(
     "mask = 00010010001010101XXXX000000X111X0111",
     "mem[32507] = 5127835",
@@ -704,10 +721,28 @@ constexpr static auto input = std::experimental::make_array(
     "mem[3777] = 9717135"
 );
 
-constexpr static auto sum_modify = memory_sum<modify>(input);
-constexpr static auto sum_decode = memory_sum<decode>(input);
+constexpr static auto sum_modified = [](auto const& array){ return memory_sum<modify>(array); };
+constexpr static auto sum_decoded = [](auto const& array){ return memory_sum<decode>(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto sum_modify = profile("memory_sum<modify>", [&]{ return memory_sum_reusing<modify>(lines); });
+        auto sum_decode = profile("memory_sum<decode>", [&]{ return memory_sum_reusing<decode>(lines); });
+        if(!sum_modify || !sum_decode){
+            std::fprintf(stderr, "%s: more addresses are written than the map holds\n", argv[1]);
+            return 1;
+        }
+        std::printf("sum modify = %lu\n", *sum_modify);
+        std::printf("sum decode = %lu\n", *sum_decode);
+        return 0;
+    }
+    auto const& sum_modify = evaluate<input, sum_modified>();
+    auto const& sum_decode = evaluate<input, sum_decoded>();
     std::printf("sum modify = %lu\n", sum_modify);
     std::printf("sum decode = %lu\n", sum_decode);
     return 0;
@@ -2,14 +2,27 @@
 #include <cstdint>
 #include <tuple>
 #include <experimental/array>
-#include <unordered_map>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/scratch.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 /*
  * Van Eck sequence
+ *
+ * Every number spoken is smaller than the number of turns, so the turn each
+ * was last spoken on fits in a table indexed by the number itself (0 for
+ * never), which is kept per thread as it is 120MB for 30000000 turns
  */
  template<std::size_t iteration, typename Array>
- constexpr auto find_spoken(Array const& array) noexcept{
-     auto history = std::unordered_map<std::uint32_t, std::uint32_t>{};
+ inline auto find_spoken(Array const& array, std::vector<std::uint32_t>& history) noexcept{
+     std::size_t size = iteration;
+     for(std::uint32_t n : array){
+         size = (n >= size ? std::size_t(n) + 1 : size);
+     }
+     history.assign(size, 0);
      for(std::uint32_t i = 0; i < array.size() - 1; ++i){
          history[array[i]] = i + 1;
      }
@@ -23,12 +36,33 @@
      return last_elem;
  }
 
-constexpr static auto input = std::experimental::make_array(
+ template<std::size_t iteration, typename Array>
+ inline auto find_spoken(Array const& array) noexcept{
+     return find_spoken<iteration>(array, scratch<std::vector<std::uint32_t>>());
+ }
+
+// Unsigned, like the numbers parsed at runtime, as no number is negative
+constexpr static auto input = std::experimental::make_array<std::uint32_t>(
     0, 6, 1, 7, 2, 19, 20
 );
 
-int main(){
-    auto answer = find_spoken<30000000>(input);
+// Thirty million turns are far beyond what the compiler can do, however
+// short the starting numbers
+constexpr static auto find_30000000th = [](auto const& array){ return find_spoken<30000000>(array); };
+
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        // A single line of comma separated numbers
+        auto numbers = profile("parse_integers", [&]{ return parse_integers<std::uint32_t>(input->text()); });
+        auto answer = profile("find_spoken", [&]{ return find_spoken<30000000>(numbers); });
+        std::printf("result = %d\n", answer);
+        return 0;
+    }
+    auto const& answer = evaluate<input, find_30000000th, 0>();
     std::printf("result = %d\n", answer);
     return 0;
 }
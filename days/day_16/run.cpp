@@ -2,25 +2,11 @@
 #include <cstdint>
 #include <tuple>
 #include <experimental/array>
-
-constexpr std::int16_t str_to_int16(char const* str, char const** endptr) noexcept{
-    std::int16_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 struct Range{
     std::int16_t lower;
@@ -77,25 +63,26 @@ constexpr auto parse_ticket(char const* line) noexcept{
 }
 
 constexpr std::size_t field_size = 20;
-constexpr std::size_t ticket_size = 235;
 
-template<std::size_t field_size, std::size_t ticket_size, typename Array>
+// Every line after the fields, my ticket, and the two headers is a nearby ticket
+
+template<std::size_t field_size, typename Array>
 constexpr auto parse_input(Array const& array) noexcept{
     auto fields = std::array<Field, field_size>{};
-    auto nearby_tickets = std::array<Ticket<field_size>, ticket_size>{};
+    auto nearby_tickets = storage_for<Ticket<field_size>, field_size + 5>(array);
     for(std::size_t i = 0; i < field_size; ++i){
         fields[i] = parse_field(array[i]);
     }
     auto my_ticket = parse_ticket<field_size>(array[field_size + 2]);
-    for(std::size_t i = 0; i < ticket_size; ++i){
+    for(std::size_t i = 0; i < nearby_tickets.size(); ++i){
         nearby_tickets[i] = parse_ticket<field_size>(array[field_size + 5 + i]);
     }
     return std::make_tuple(fields, my_ticket, nearby_tickets);
 }
 
-template<std::size_t field_size, std::size_t ticket_size, typename Array>
+template<std::size_t field_size, typename Array>
 constexpr auto find_error_rate(Array const& array) noexcept{
-    auto [fields, my_ticket, nearby_tickets] = parse_input<field_size, ticket_size>(array);
+    auto [fields, my_ticket, nearby_tickets] = parse_input<field_size>(array);
     std::size_t error_rate = 0;
     for(auto& nearby_ticket : nearby_tickets){
         for(auto const& field : nearby_ticket.fields){
@@ -112,9 +99,9 @@ constexpr auto find_error_rate(Array const& array) noexcept{
     return std::make_tuple(fields, my_ticket, nearby_tickets, error_rate);
 }
 
-template<std::size_t field_size, std::size_t ticket_size, typename Array>
+template<std::size_t field_size, typename Array>
 constexpr auto find_departure_mul(Array const& array) noexcept{
-    auto [fields, my_ticket, nearby_tickets, error_rate] = find_error_rate<field_size, ticket_size>(array);
+    auto [fields, my_ticket, nearby_tickets, error_rate] = find_error_rate<field_size>(array);
     auto bool_board = std::array<std::uint32_t, field_size>{};
     auto field_map = std::array<std::size_t, field_size>{};
     // Iterate through columns...
@@ -440,9 +427,24 @@ constexpr static auto input = std::experimental::make_array(
     "572,367,922,916,416,116,859,589,587,633,688,272,692,578,885,803,282,207,563,641"
 );
 
-constexpr static auto result = find_departure_mul<20, 235>(input);
+constexpr static auto find_departure_fields = [](auto const& array){ return find_departure_mul<field_size>(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        if(lines.size() < field_size + 5 || *lines[field_size] != '\0'){
+            std::fprintf(stderr, "%s: expected %lu fields\n", argv[1], field_size);
+            return 1;
+        }
+        auto departure_mul = profile("find_departure_mul", [&]{ return find_departure_mul<field_size>(lines); });
+        std::printf("result = %lu\n", departure_mul);
+        return 0;
+    }
+    auto const& result = evaluate<input, find_departure_fields>();
     std::printf("result = %lu\n", result);
     return 0;
 }
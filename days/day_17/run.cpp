@@ -2,6 +2,11 @@
 #include <tuple>
 #include <experimental/array>
 #include <type_traits>
+#include <string_view>
+#include <vector>
+#include "../common/input.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
@@ -50,6 +55,43 @@ constexpr auto make_grid(CharConstPtr<size> value, Ts&&... values) noexcept{
     }(value, std::forward<Ts>(values)...)};
 }
 
+/*
+ * Grid read at runtime - the same members, but
+ * only known once the input has been indexed
+ */
+template<>
+struct Grid<std::string_view, 0>{
+    std::size_t no_of_rows;
+    std::size_t no_of_cols;
+
+    std::vector<std::vector<char>> array;
+
+    auto& operator[](std::size_t index) noexcept{
+        return array[index];
+    }
+
+    auto const& operator[](std::size_t index) const noexcept{
+        return array[index];
+    }
+
+    bool operator==(Grid const& that) const noexcept{
+        return this->array == that.array;
+    }
+
+    bool operator!=(Grid const& that) const noexcept{
+        return !(*this == that);
+    }
+};
+
+inline auto make_grid(std::vector<std::string_view> const& lines) noexcept{
+    auto no_of_cols = (lines.empty() ? 0 : lines[0].size());
+    auto grid = Grid<std::string_view, 0>{lines.size(), no_of_cols, {}};
+    for(auto line : lines){
+        grid.array.emplace_back(line.begin(), line.end());
+    }
+    return grid;
+}
+
 ///
 
 template<std::size_t...>
@@ -83,6 +125,34 @@ struct Dimension<>{
     }
 };
 
+/*
+ * Dimension with its size only known at runtime
+ * The innermost dimension is the same single cube as before
+ */
+template<std::size_t d>
+struct DynamicDimension{
+    constexpr static std::size_t dimensionality = d;
+    using dim_type = DynamicDimension<d - 1>;
+
+    explicit DynamicDimension(std::size_t size) noexcept
+        : size{size}, value(size, dim_type{size}){}
+
+    template<typename F, typename... Is>
+    void for_each(F&& f, Is&&... is) noexcept{
+        for(std::size_t i = 0; i < size; ++i){
+            value[i].for_each(std::forward<F>(f), std::forward<Is>(is)..., i);
+        }
+    }
+
+    std::size_t size;
+    std::vector<dim_type> value;
+};
+
+template<>
+struct DynamicDimension<0> : Dimension<>{
+    explicit DynamicDimension(std::size_t) noexcept{}
+};
+
 // Checking functions that work regardless of dimension
 
 template<std::size_t index, typename A, typename Indices>
@@ -143,10 +213,15 @@ constexpr auto make_dimension(G const& grid, std::index_sequence<I0, I1, Is...>
     return Dimension<size, size, (size * bool(Is + 1))...>{};
 }
 
+template<std::size_t no_of_cycles, std::size_t I0, std::size_t I1, std::size_t... Is>
+inline auto make_dimension(Grid<std::string_view, 0> const& grid, std::index_sequence<I0, I1, Is...> const&) noexcept{
+    return DynamicDimension<2 + sizeof...(Is)>{2 * no_of_cycles + grid.no_of_rows};
+}
+
 template<typename D>
 constexpr void init_impl(D& dimension, char c) noexcept{
-    if constexpr(D::size > 0){
-        init_impl(dimension.value[D::size / 2], c);
+    if constexpr(D::dimensionality > 0){
+        init_impl(dimension.value[dimension.size / 2], c);
     } else{
         dimension.value = c;
     }
@@ -156,8 +231,8 @@ template<typename D, typename G>
 constexpr void init(D& dimension, G const& grid) noexcept{
     for(std::size_t i = 0; i < grid.no_of_rows; ++i){
         for(std::size_t j = 0; j < grid.no_of_cols; ++j){
-            auto a = D::size / 2 - grid.no_of_rows / 2 + i;
-            auto b = D::dim_type::size / 2 - grid.no_of_cols / 2 + j;
+            auto a = dimension.size / 2 - grid.no_of_rows / 2 + i;
+            auto b = dimension.value[a].size / 2 - grid.no_of_cols / 2 + j;
             init_impl(dimension.value[a].value[b], grid[i][j]);
         }
     }
@@ -197,8 +272,22 @@ constexpr static auto input = make_grid(
     ".....#.."
 );
 
-int main(){
-    auto result = cycle<4, 6>(input);
+// Six cycles in four dimensions take longer than the compiler allows, however
+// small the starting grid
+constexpr static auto run_six_cycles = [](auto const& grid){ return cycle<4, 6>(grid); };
+
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto grid = profile("make_grid", [&]{ return make_grid(index_lines(*input)); });
+        auto result = profile("cycle", [&]{ return cycle<4, 6>(grid); });
+        std::printf("result = %lu\n", result);
+        return 0;
+    }
+    auto const& result = evaluate<input, run_six_cycles, 0>();
     std::printf("result = %lu\n", result);
     return 0;
 }
@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <experimental/array>
 #include <variant>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
+#include "../common/evaluate.hpp"
 
 template<typename T, std::size_t capacity>
 struct Stack{
@@ -24,25 +28,6 @@ struct Stack{
     std::array<T, capacity> array;
 };
 
-constexpr std::size_t str_to_size_t(char const* str, char const** endptr) noexcept{
-    std::size_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 constexpr auto is_space(char c) noexcept{
     return c == ' ';
 }
@@ -527,9 +512,20 @@ constexpr static auto input = std::experimental::make_array(
     "8 * 7 * (3 * 4 + 6 + 2 * 9 + 9) * 3 + (3 + 5)"
 );
 
-constexpr static auto result = sum_of_expressions<2, 1>(input);
+constexpr static auto sum_of_all = [](auto const& array){ return sum_of_expressions<2, 1>(array); };
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto result = profile("sum_of_expressions", [&]{ return sum_of_expressions<2, 1>(lines); });
+        std::printf("result = %lu\n", result);
+        return 0;
+    }
+    auto const& result = evaluate<input, sum_of_all>();
     std::printf("result = %lu\n", result);
     return 0;
 }
@@ -2,7 +2,12 @@
 #include <experimental/array>
 #include <variant>
 #include <map>
+#include <unordered_map>
 #include <regex>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 /*
  * Day 19 has arguably been a terrible day for me; there are later days which
@@ -30,25 +35,6 @@
 template<typename... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<typename... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
-constexpr std::uint8_t str_to_uint8(char const* str, char const** endptr) noexcept{
-    std::uint8_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
-
 constexpr auto is_space(char c) noexcept{
     return c == ' ';
 }
@@ -188,8 +174,10 @@ constexpr std::size_t sum_for_rule(Array const& array) noexcept{
         }
     }
 
-    auto regex = build_regex<replace_specific_rules>(table, table[0]);
+    allocation_phase("build");
+    auto regex = profile("build_regex", [&]{ return build_regex<replace_specific_rules>(table, table[0]); });
 
+    allocation_phase("solve");
     std::size_t sum = 0;
     for(; i < array.size(); ++i){
         auto const* str = array[i];
@@ -882,7 +870,18 @@ constexpr static auto input = std::experimental::make_array(
     "aabaabbbabbaaaabaabbabaabaaaabba"
 );
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto result = profile("sum_for_rule", [&]{ return sum_for_rule<true>(lines); });
+        std::printf("result = %lu\n", result);
+        return 0;
+    }
     auto result = sum_for_rule<true>(input);
     std::printf("result = %lu\n", result);
     return 0;
@@ -6,25 +6,11 @@
 #include <unordered_set>
 #include <functional>
 #include <bitset>
-
-constexpr std::uint16_t str_to_uint16(char const* str, char const** endptr) noexcept{
-    std::uint16_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
+#include <utility>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 template<std::size_t size>
 constexpr auto reverse_bits(std::bitset<size> bits) noexcept{
@@ -141,14 +127,11 @@ struct Tile{
     std::array<std::bitset<10>, 10> grid;
 };
 
-namespace std{
-    template<>
-    struct hash<Tile>{
-        constexpr std::size_t operator()(Tile const& tile) const noexcept{
-            return tile.id;
-        }
-    };
-}
+struct TileHash{
+    constexpr std::size_t operator()(Tile const& tile) const noexcept{
+        return tile.id;
+    }
+};
 
 constexpr auto calc_side_info(std::ptrdiff_t dy, std::ptrdiff_t dx) noexcept{
     auto side = (dx == 0
@@ -270,7 +253,7 @@ struct Grid{
     constexpr auto stitched_borderless(std::size_t j, std::size_t i) const noexcept{
         return grid[j / 8][i / 8].grid[j % 8 + 1][i % 8 + 1];
     }
-    std::unordered_set<Tile> set{};
+    std::unordered_set<Tile, TileHash> set{};
     std::array<std::array<Tile, grid_size>, grid_size> grid{};
 };
 
@@ -355,16 +338,20 @@ template<std::size_t grid_size, typename Array>
 constexpr auto find_corners_product(Array const& array) noexcept{
     auto tiles = std::array<Tile, grid_size * grid_size>{};
     std::size_t i = 0;
-    for(std::size_t k = 0; k < array.size(); k += 12){
-        tiles[i++] = parse_tile(array, k);
-    }
-    auto graph = build_graph(tiles);
+    profile("parse_input", [&]{
+        for(std::size_t k = 0; k < array.size(); k += 12){
+            tiles[i++] = parse_tile(array, k);
+        }
+    });
+    allocation_phase("build");
+    auto graph = profile("build_graph", [&]{ return build_graph(tiles); });
+    allocation_phase("solve");
     auto success = false;
     auto grid = Grid<grid_size>{};
     tile_iterator([&](auto const& rotated_tile, auto& continue_iterating){
         grid.grid[0][0] = rotated_tile;
         grid.set.insert(rotated_tile);
-        success = find_corners_product_impl(grid, graph, 0);
+        success = profile("find_corners_product_impl", [&]{ return find_corners_product_impl(grid, graph, 0); });
         if(!success){
             grid.grid[0][0] = Tile{};
             grid.set.erase(rotated_tile);
@@ -567,7 +554,45 @@ constexpr static auto test_input = std::experimental::make_array(
     ""
 );
 
-int main(){
+/*
+ * The grid size is a template argument, so an input read at runtime
+ * is dispatched to one of the supported sizes
+ */
+constexpr static std::size_t max_grid_size = 12;
+
+template<std::size_t grid_size, typename Array>
+inline void print_product_and_roughness(Array const& array) noexcept{
+    auto [product, grid] = profile("find_corners_product", [&]{ return find_corners_product<grid_size>(array); });
+    std::printf("product   = %lu\n", product);
+    auto sum = profile("find_nessies", [&, &grid = grid]{ return find_nessies(grid); });
+    std::printf("roughness = %lu\n", sum);
+}
+
+template<typename Array, std::size_t... grid_sizes>
+inline auto print_product_and_roughness(Array const& array, std::size_t grid_size, std::index_sequence<grid_sizes...> const&) noexcept{
+    return ((grid_size == grid_sizes + 1 && (print_product_and_roughness<grid_sizes + 1>(array), true)) || ...);
+}
+
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto no_of_tiles = (lines.size() + 1) / 12;
+        std::size_t grid_size = 0;
+        while((grid_size + 1) * (grid_size + 1) <= no_of_tiles){
+            ++grid_size;
+        }
+        if(grid_size * grid_size != no_of_tiles
+            || !print_product_and_roughness(lines, grid_size, std::make_index_sequence<max_grid_size>{})){
+            std::fprintf(stderr, "%s: expected a square of at most %lu by %lu tiles\n", argv[1], max_grid_size, max_grid_size);
+            return 1;
+        }
+        return 0;
+    }
     auto input = std::vector<char const*>{{
         "Tile 1753:",
         "..##.#.#.#",
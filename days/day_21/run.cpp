@@ -8,6 +8,9 @@
 #include <algorithm>
 #include <numeric>
 #include <string_view>
+#include "../common/input.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 template<std::size_t size>
 using CharConstPtr = char const (&)[size];
@@ -133,14 +136,15 @@ constexpr void print_canonical_dangerous_ingredient_list(Allergens allergens) no
     std::printf("\n");
 }
 
-template<std::size_t size>
-constexpr void print_compilation_of_foods(std::array<char const*, size> const& array) noexcept{
-    auto foods = std::array<Food, size>{};
+template<typename Array>
+constexpr void print_compilation_of_foods(Array const& array) noexcept{
+    auto foods = storage_for<Food>(array);
     std::size_t i = 0;
     for(auto const* str : array){
         foods[i++] = parse_food(std::string_view{str});
     }
 
+    allocation_phase("build");
     auto map = std::unordered_map<std::string_view, std::unordered_set<std::string_view>>{};
     for(auto const& food : foods){
         for(auto ingredient : food.ingredients){
@@ -150,6 +154,7 @@ constexpr void print_compilation_of_foods(std::array<char const*, size> const& a
         }
     }
 
+    allocation_phase("solve");
     auto not_allergens = find_not_allergens(map, foods);    // modifies the map
     auto allergens = find_allergens(map);                   // modifies the map
     std::printf("number of not allergens             = %lu\n", occurrences(not_allergens, foods));
@@ -204,7 +209,17 @@ constexpr static auto input = std::experimental::make_array(
     "jgbk gvdstsc spnd rtmfg psqc njdb drtdz thtlt dxrsgs cldgd hjvzcp nggbtk dfcgd nppxr mbmtz gcpks rdjdq lzvh czvphx rjc vnbfvkp mhrlx frxmq bfnnnrn kmlkx qpbl lsgqf ldrgj qrpzt jp bvpxc phc zmsdzh jbtlfv nhzthvn rsr jxvx th rzcps kdbxxzv xgpdnz nqvnn rdkrtr pmhhqrk pdt prbk rbjmdn fgptl gpjr zbxj czmml tqkfx xdcp njqrhcc cncpbssj chgjqc fgcd (contains nuts, dairy, eggs)"
 );
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        profile("print_compilation_of_foods", [&]{ print_compilation_of_foods(lines); });
+        return 0;
+    }
     print_compilation_of_foods(input);
     return 0;
 }
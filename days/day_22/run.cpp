@@ -3,25 +3,10 @@
 #include <experimental/array>
 #include <vector>
 #include <deque>
-
-constexpr std::size_t str_to_size_t(char const* str, char const** endptr) noexcept{
-    std::size_t i = 0;
-    for(; *str != '\0'; ++str){
-        char c = *str;
-        if('0' <= c && c <= '9'){
-            i = i * 10 + (c - '0');
-        } else{
-            if(endptr){
-                *endptr = str;
-            }
-            return i;
-        }
-    }
-    if(endptr){
-        *endptr = str;
-    }
-    return i;
-}
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 template<typename Array>
 inline auto parse_input(Array const& array) noexcept{
@@ -95,6 +80,7 @@ constexpr std::tuple<bool, std::size_t> combat(Deque player_1, Deque player_2) n
 template<bool is_recursive, typename Array>
 constexpr auto winning_players_score(Array const& array) noexcept{
     auto [player_1, player_2] = parse_input(array);
+    allocation_phase("solve");
     auto [is_player_1_winner, score] = combat<is_recursive>(player_1, player_2);
     return score;
 }
@@ -171,7 +157,18 @@ constexpr static auto input = std::experimental::make_array(
     "28"
 );
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto score = profile("winning_players_score", [&]{ return winning_players_score<true>(lines); });
+        std::printf("score = %lu\n", score);
+        return 0;
+    }
     auto score = winning_players_score<true>(input);
     std::printf("score = %lu\n", score);
     return 0;
@@ -2,6 +2,11 @@
 #include <cstdint>
 #include <cmath>
 #include <vector>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/scratch.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 struct Element{
     std::size_t value = 0;
@@ -66,9 +71,11 @@ constexpr auto wrap(std::size_t i) noexcept{
 
 template<std::size_t simulations, std::size_t ring_size, typename F>
 constexpr decltype(auto) simulate(std::size_t value, F&& f) noexcept{
-    auto memory = std::vector<Element>{};   // Initialise memory here so that we
-    memory.reserve(ring_size + 1);          // don't have to handle it ourselves
+    allocation_phase("build");
+    auto& memory = scratch<std::vector<Element>>(); // Reused by every call on
+    memory.assign(ring_size + 1, Element{});         // this thread
     auto ring = parse_input<ring_size>(memory, value);
+    allocation_phase("solve");
     auto* start = ring.head;
     for(std::size_t s = 0; s < simulations; ++s){
         // Find the correct v value first
@@ -128,7 +135,20 @@ constexpr auto product_of_two_stars(std::size_t value) noexcept{
 constexpr static std::size_t test_input = 389125467;
 constexpr static std::size_t input = 583976241;
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto value = str_to_size_t(input->data, nullptr);
+        auto result = profile("simulate_100_moves", [&]{ return simulate_100_moves(value); });
+        auto product = profile("product_of_two_stars", [&]{ return product_of_two_stars(value); });
+        std::printf("result  = %lu\n", result);
+        std::printf("product = %lu\n", product);
+        return 0;
+    }
     auto result = simulate_100_moves(input);
     auto product = product_of_two_stars(input);
     std::printf("result  = %lu\n", result);
@@ -4,6 +4,9 @@
 #include <unordered_map>
 #include <algorithm>
 #include <limits>
+#include "../common/input.hpp"
+#include "../common/allocations.hpp"
+#include "../common/profile.hpp"
 
 struct Tile{
     std::ptrdiff_t q;
@@ -472,7 +475,21 @@ constexpr static auto input = std::experimental::make_array(
     "weseneseeneneneweeswewnesesewsw"
 );
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        allocation_phase("parse");
+        auto lines = profile("index_lines", [&]{ return c_strs(index_lines(*input)); });
+        auto floor = profile("flipping_process", [&]{ return flipping_process(lines); });
+        std::printf("day 0   = %lu\n", count(floor));
+        allocation_phase("solve");
+        floor = profile("simulate_n_days", [&]{ return simulate_n_days<100>(floor); });
+        std::printf("day 100 = %lu\n", count(floor));
+        return 0;
+    }
     auto floor = flipping_process(input);
     std::printf("day 0   = %lu\n", count(floor));
     floor = simulate_n_days<100>(floor);
@@ -1,5 +1,8 @@
 #include <cstdio>
 #include <limits>
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/profile.hpp"
 
 constexpr auto find_encryption_key(std::size_t card_public_key, std::size_t door_public_key) noexcept{
     std::size_t value = 1;
@@ -24,7 +27,21 @@ constexpr static auto door_public_key = 10464955;
 
 constexpr static auto encryption_key = find_encryption_key(card_public_key, door_public_key);
 
-int main(){
+int main(int argc, char** argv){
+    if(argc > 1){
+        auto input = map_input(argv[1]);
+        if(!input){
+            return 1;
+        }
+        auto keys = profile("parse_integers", [&]{ return parse_integers<std::size_t>(input->text()); });
+        if(keys.size() < 2){
+            std::fprintf(stderr, "%s: expected the card and door public keys\n", argv[1]);
+            return 1;
+        }
+        auto key = profile("find_encryption_key", [&]{ return find_encryption_key(keys[0], keys[1]); });
+        std::printf("encryption_key = %lu\n", key);
+        return 0;
+    }
     std::printf("encryption_key = %lu\n", encryption_key);
     return 0;
 }
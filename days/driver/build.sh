@@ -0,0 +1,27 @@
+
+# Each day is compiled on its own, with the flags from its own build.sh and
+# its `main` renamed, and linked into one object with `day.cpp`, which
+# registers it with the driver
+# The day is built with hidden symbols, which are then made local to that
+# object and taken out of their COMDAT groups, so that days defining the same
+# names (`input`, `sort`, `count_valid`...) each keep their own
+# A day that does not build fails the whole build
+# Pass day numbers (e.g. `sh build.sh 01 15 23`) to build only those days
+days=${*:-$(cd .. && ls -d day_* | sed 's/day_//')}
+objects=""
+for day in $days; do
+    dir=../day_$day
+    flags=$(sed -n 's/^g++ \(.*\) -o run run\.cpp.*$/\1/p' "$dir/build.sh" | tr -d '\r')
+    if ! g++ $flags -fvisibility=hidden -fvisibility-inlines-hidden -fno-gnu-unique -fno-builtin-printf \
+            -Dmain=day_${day}_main -c "$dir/run.cpp" -o day_$day.main.o ||
+        ! g++ -O3 -std=c++17 -DDAY=${day#0} -DDAY_MAIN=day_${day}_main -c day.cpp -o day_$day.day.o ||
+        ! ld -r -o day_$day.o day_$day.main.o day_$day.day.o ||
+        ! objcopy --localize-hidden --remove-section=.group day_$day.o; then
+        echo "error: day_$day does not build" >&2
+        exit 1
+    fi
+    rm -f day_$day.main.o day_$day.day.o
+    objects="$objects day_$day.o"
+done
+# What the days print goes through the driver's `__wrap_printf`
+g++ -O3 -std=c++17 -pthread -Wl,--wrap=printf -o run run.cpp $objects
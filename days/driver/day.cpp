@@ -0,0 +1,10 @@
+#include "driver.hpp"
+
+/*
+ * One day's registration with the driver - compiled once per day by
+ * `build.sh`, with DAY and DAY_MAIN set, and linked together with the day's
+ * own source, built with its own flags and its `main` renamed to DAY_MAIN
+ */
+int DAY_MAIN(int, char**);
+
+static auto const registered = register_day(DAY, DAY_MAIN);
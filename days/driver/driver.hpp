@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+/*
+ * The days, each built on its own with its `main` renamed (see `build.sh`)
+ * and registered with the driver by `day.cpp`
+ * Defined in `run.cpp` alone, as the days' objects keep nothing shared
+ */
+struct Day{
+    unsigned number;
+    int (*main)(int, char**);
+};
+
+std::vector<Day>& registered_days() noexcept;
+bool register_day(unsigned number, int (*main)(int, char**)) noexcept;
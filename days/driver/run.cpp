@@ -0,0 +1,282 @@
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include "driver.hpp"
+#include "../common/input.hpp"
+#include "../common/parse.hpp"
+#include "../common/pool.hpp"
+
+/*
+ * Multi-day driver - every day linked into one binary and run side by side
+ *
+ *     ./run [-j threads] [-i input dir] [day...]
+ *     ./run [-j threads] -b manifest
+ *
+ * With an input directory each day solves `<input dir>/day_NN.txt` at
+ * runtime, otherwise it prints the answers compiled into it
+ * The days known to take longest are started first, so that the total time
+ * approaches that of the slowest day rather than the sum of all of them
+ *
+ * In batch mode the manifest lists one `<day> <input file>` per line, and
+ * every input is solved at runtime, with one NDJSON line streamed out per
+ * input as soon as it is done
+ */
+constexpr static unsigned long_days[] = {15, 23};
+
+std::vector<Day>& registered_days() noexcept{
+    static auto days = std::vector<Day>{};
+    return days;
+}
+
+bool register_day(unsigned number, int (*main)(int, char**)) noexcept{
+    registered_days().push_back({number, main});
+    return true;
+}
+
+/*
+ * Output - the days run side by side, so what they print is collected per
+ * thread and printed by the driver once they are done
+ * Every call to `printf` in the binary, the days' as well as the driver's
+ * own, is linked to this instead (`-Wl,--wrap=printf`)
+ */
+thread_local std::string* captured_output = nullptr;
+
+extern "C" __attribute__((format(printf, 1, 2)))
+int __wrap_printf(char const* format, ...){
+    std::va_list args;
+    va_start(args, format);
+    if(!captured_output){
+        auto n = std::vprintf(format, args);
+        va_end(args);
+        return n;
+    }
+    std::va_list copy;
+    va_copy(copy, args);
+    auto n = std::vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+    if(n > 0){
+        auto size = captured_output->size();
+        captured_output->resize(size + std::size_t(n) + 1);
+        std::vsnprintf(captured_output->data() + size, std::size_t(n) + 1, format, args);
+        captured_output->resize(size + std::size_t(n));
+    }
+    va_end(args);
+    return n;
+}
+
+struct Job{
+    Day day;
+    std::string input;
+    std::string output;
+    double latency_ms;
+    int status;
+};
+
+inline bool is_long(unsigned day) noexcept{
+    return std::find(std::begin(long_days), std::end(long_days), day) != std::end(long_days);
+}
+
+inline Day const* find_day(unsigned number) noexcept{
+    for(auto const& day : registered_days()){
+        if(day.number == number){
+            return &day;
+        }
+    }
+    return nullptr;
+}
+
+/*
+ * Run a day's `main`, collecting what it prints into `output`
+ */
+inline void run_job(Job& job) noexcept{
+    char name[16];
+    std::snprintf(name, sizeof(name), "day_%02u", job.day.number);
+    auto args = std::vector<char*>{name};
+    if(!job.input.empty()){
+        args.push_back(job.input.data());
+    }
+    args.push_back(nullptr);
+
+    captured_output = &job.output;
+    auto begin = std::chrono::steady_clock::now();
+    job.status = job.day.main(int(args.size() - 1), args.data());
+    auto end = std::chrono::steady_clock::now();
+    captured_output = nullptr;
+    job.latency_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+/*
+ * Batch mode
+ */
+inline void append_json_string(std::string& line, std::string_view str) noexcept{
+    line += '"';
+    for(auto c : str){
+        switch(c){
+            case '"': line += "\\\""; break;
+            case '\\': line += "\\\\"; break;
+            case '\n': line += "\\n"; break;
+            case '\r': line += "\\r"; break;
+            case '\t': line += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20){
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(c));
+                    line += escaped;
+                } else{
+                    line += c;
+                }
+        }
+    }
+    line += '"';
+}
+
+// {"day":N,"input":"...","status":N,"ms":N,"answers":["...",...]}
+inline void format_result(std::string& line, Job const& job) noexcept{
+    char number[64];
+    line.clear();
+    std::snprintf(number, sizeof(number), "{\"day\":%u,\"input\":", job.day.number);
+    line += number;
+    append_json_string(line, job.input);
+    std::snprintf(number, sizeof(number), ",\"status\":%d,\"ms\":%.3f,\"answers\":[",
+        job.status, job.latency_ms);
+    line += number;
+    auto output = std::string_view{job.output};
+    auto first = true;
+    while(!output.empty()){
+        auto end = output.find('\n');
+        auto answer = output.substr(0, end);
+        if(!answer.empty()){
+            line += (first ? "" : ",");
+            append_json_string(line, answer);
+            first = false;
+        }
+        output.remove_prefix(end == std::string_view::npos ? output.size() : end + 1);
+    }
+    line += "]}\n";
+}
+
+inline int run_batch(char const* manifest, std::size_t threads) noexcept{
+    auto file = map_input(manifest);
+    if(!file){
+        return 1;
+    }
+    auto jobs = std::vector<Job>{};
+    for(auto line : index_lines(*file)){
+        auto* str = line.data();
+        if(line.empty() || *str == '#'){
+            continue;
+        }
+        auto number = str_to_uint32(str, &str);
+        auto const* day = find_day(number);
+        if(!day){
+            std::fprintf(stderr, "%s: day %u is not in the driver\n", manifest, number);
+            return 1;
+        }
+        for(; *str == ' ' || *str == '\t'; ++str);
+        jobs.push_back(Job{*day, str, {}, 0, 0});
+    }
+
+    // Each thread reuses its own buffers, so nothing grows per input
+    threads = std::max<std::size_t>(1, std::min(threads, jobs.size()));
+    auto outputs = std::vector<std::string>(threads);
+    auto lines = std::vector<std::string>(threads);
+    auto mutex = std::mutex{};
+    auto failures = std::size_t{0};
+    auto begin = std::chrono::steady_clock::now();
+    run_parallel(jobs.size(), threads, [&](std::size_t i, std::size_t thread){
+        auto& job = jobs[i];
+        std::swap(job.output, outputs[thread]);
+        job.output.clear();
+        run_job(job);
+        format_result(lines[thread], job);
+        std::swap(job.output, outputs[thread]);
+
+        auto lock = std::lock_guard{mutex};
+        std::fwrite(lines[thread].data(), 1, lines[thread].size(), stdout);
+        std::fflush(stdout);
+        failures += (job.status != 0);
+    });
+    auto end = std::chrono::steady_clock::now();
+    auto seconds = std::chrono::duration<double>(end - begin).count();
+    std::fprintf(stderr, "%lu inputs on %lu threads in %.3f s: %.1f inputs/s/core, %lu failed\n",
+        jobs.size(), threads, seconds, double(jobs.size()) / seconds / double(threads), failures);
+    return failures == 0 ? 0 : 1;
+}
+
+inline void usage(char const* self) noexcept{
+    std::fprintf(stderr,
+        "usage: %s [-j threads] [-i input dir] [day...]\n"
+        "       %s [-j threads] -b manifest\n", self, self);
+}
+
+int main(int argc, char** argv){
+    auto threads = default_threads();
+    auto input_dir = std::string{};
+    char const* manifest = nullptr;
+    for(int opt; (opt = getopt(argc, argv, "j:i:b:h")) != -1;){
+        switch(opt){
+            case 'j': threads = std::strtoul(optarg, nullptr, 10); break;
+            case 'i': input_dir = optarg; break;
+            case 'b': manifest = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if(manifest){
+        return run_batch(manifest, threads);
+    }
+    auto selected = std::vector<unsigned>{};
+    for(int i = optind; i < argc; ++i){
+        selected.push_back(unsigned(std::strtoul(argv[i], nullptr, 10)));
+    }
+
+    auto jobs = std::vector<Job>{};
+    for(auto const& day : registered_days()){
+        if(!selected.empty() && std::find(selected.begin(), selected.end(), day.number) == selected.end()){
+            continue;
+        }
+        auto job = Job{day, {}, {}, 0, 0};
+        if(!input_dir.empty()){
+            char name[32];
+            std::snprintf(name, sizeof(name), "/day_%02u.txt", day.number);
+            job.input = input_dir + name;
+        }
+        jobs.push_back(std::move(job));
+    }
+    // Long days first, the rest in order
+    std::sort(jobs.begin(), jobs.end(), [](auto const& a, auto const& b){
+        if(is_long(a.day.number) != is_long(b.day.number)){
+            return is_long(a.day.number);
+        }
+        return a.day.number < b.day.number;
+    });
+
+    auto begin = std::chrono::steady_clock::now();
+    run_parallel(jobs.size(), threads, [&](std::size_t job, std::size_t){
+        run_job(jobs[job]);
+    });
+    auto end = std::chrono::steady_clock::now();
+    auto makespan = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    std::sort(jobs.begin(), jobs.end(), [](auto const& a, auto const& b){
+        return a.day.number < b.day.number;
+    });
+    auto total = 0.0;
+    auto failures = 0;
+    for(auto const& job : jobs){
+        std::printf("day_%02u  %10.3f ms%s\n%s", job.day.number, job.latency_ms,
+            job.status == 0 ? "" : "  (failed)", job.output.c_str());
+        total += job.latency_ms;
+        failures += (job.status != 0);
+    }
+    std::printf("%lu days on %lu threads: makespan %.3f ms, sum of days %.3f ms\n",
+        jobs.size(), std::min(threads, jobs.size()), makespan, total);
+    return failures == 0 ? 0 : 1;
+}
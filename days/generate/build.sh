@@ -0,0 +1,2 @@
+
+g++ -O3 -std=c++17 -o run run.cpp
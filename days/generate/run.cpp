@@ -0,0 +1,1166 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <set>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <random>
+#include <unistd.h>
+
+/*
+ * Input generators - a valid, solvable input for any day, at any scale
+ *
+ *     ./run [-s seed] [-n scale] [-k knob=value]... day > input.txt
+ *
+ * The scale is the size of the input in that day's own terms (lines,
+ * records, bag colours, grid size...), and knobs control its structure
+ * `./run -h` lists both for every day
+ * The same seed, scale and knobs always give the same input
+ */
+
+struct Knob{
+    char const* name;
+    std::size_t value;
+};
+
+struct Generator{
+    std::mt19937_64 rng;
+    std::size_t scale;
+    std::vector<Knob> knobs;
+    unsigned day;
+
+    // A knob given on the command line, or its default
+    std::size_t knob(char const* name, std::size_t value) const noexcept{
+        for(auto const& k : knobs){
+            if(std::strcmp(k.name, name) == 0){
+                return k.value;
+            }
+        }
+        return value;
+    }
+    std::size_t size(std::size_t value) const noexcept{
+        return scale > 0 ? scale : value;
+    }
+
+    // A scale or knob kept to what the day can generate, saying so when it is not
+    std::size_t within(char const* what, std::size_t value, std::size_t lo, std::size_t hi) const noexcept{
+        auto kept = std::clamp(value, lo, hi);
+        if(kept != value){
+            std::fprintf(stderr, "day %02u: %s of %lu is out of range, using %lu\n", day, what, value, kept);
+        }
+        return kept;
+    }
+    std::size_t at_least(char const* what, std::size_t value, std::size_t lo) const noexcept{
+        return within(what, value, lo, std::numeric_limits<std::size_t>::max());
+    }
+
+    // Uniform in [lo, hi]
+    std::int64_t between(std::int64_t lo, std::int64_t hi) noexcept{
+        return std::uniform_int_distribution<std::int64_t>{lo, hi}(rng);
+    }
+    std::size_t below(std::size_t n) noexcept{
+        return std::uniform_int_distribution<std::size_t>{0, n - 1}(rng);
+    }
+    bool chance(std::size_t percent) noexcept{
+        return below(100) < percent;
+    }
+    template<typename T>
+    auto const& pick(T const& values) noexcept{
+        return values[below(std::size(values))];
+    }
+    template<typename T>
+    void shuffle(T& values) noexcept{
+        std::shuffle(std::begin(values), std::end(values), rng);
+    }
+    std::string word(std::size_t lo, std::size_t hi) noexcept{
+        auto str = std::string(std::size_t(between(std::int64_t(lo), std::int64_t(hi))), 'a');
+        for(auto& c : str){
+            c = char('a' + below(26));
+        }
+        return str;
+    }
+};
+
+inline void print_lines(std::vector<std::string> const& lines) noexcept{
+    for(auto const& line : lines){
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::putchar('\n');
+    }
+}
+
+// Words no two of which are the same
+inline std::vector<std::string> unique_words(Generator& g, std::size_t n, std::size_t lo, std::size_t hi) noexcept{
+    auto seen = std::set<std::string>{};
+    auto words = std::vector<std::string>{};
+    while(words.size() < n){
+        auto w = g.word(lo, hi);
+        if(seen.insert(w).second){
+            words.push_back(w);
+        }
+    }
+    return words;
+}
+
+// How many pairs and how many triples of the entries sum to 2020
+inline std::pair<std::size_t, std::size_t> answers_01(std::vector<std::int64_t> const& entries) noexcept{
+    auto pairs = std::size_t(0);
+    auto triples = std::size_t(0);
+    for(std::size_t i = 0; i < entries.size(); ++i){
+        for(std::size_t j = i + 1; j < entries.size(); ++j){
+            pairs += (entries[i] + entries[j] == 2020);
+            for(std::size_t k = j + 1; k < entries.size(); ++k){
+                triples += (entries[i] + entries[j] + entries[k] == 2020);
+            }
+        }
+    }
+    return {pairs, triples};
+}
+
+/*
+ * Day 01 - entries, with one pair and one triple summing to 2020
+ * The pair and the triple are drawn again until they are the only answers
+ * among themselves, and every other entry is over 1010, so that two or three
+ * of those never sum to 2020, and is drawn again when it would sum to 2020
+ * with one or two of the pair and the triple
+ */
+inline void generate_01(Generator& g) noexcept{
+    auto n = g.at_least("entries", g.size(200), 5);
+    auto entries = std::vector<std::int64_t>{};
+    do{
+        auto a = g.between(1, 1009);
+        auto b = g.between(1, 600);
+        auto c = g.between(1, 600);
+        entries = {a, 2020 - a, b, c, 2020 - b - c};
+    } while(answers_01(entries) != std::pair<std::size_t, std::size_t>{1, 1});
+    auto taken = std::vector<bool>(2021);
+    for(std::size_t i = 0; i < entries.size(); ++i){
+        taken[std::size_t(2020 - entries[i])] = true;
+        for(std::size_t j = i + 1; j < entries.size(); ++j){
+            if(entries[i] + entries[j] < 2020){
+                taken[std::size_t(2020 - entries[i] - entries[j])] = true;
+            }
+        }
+    }
+    while(entries.size() < n){
+        auto entry = g.between(1011, 2019);
+        if(!taken[std::size_t(entry)]){
+            entries.push_back(entry);
+        }
+    }
+    g.shuffle(entries);
+    for(auto e : entries){
+        std::printf("%ld\n", e);
+    }
+}
+
+/*
+ * Day 02 - password policies
+ */
+inline void generate_02(Generator& g) noexcept{
+    auto n = g.size(1000);
+    auto length = g.at_least("length", g.knob("length", 20), 3);
+    for(std::size_t i = 0; i < n; ++i){
+        auto x = g.between(1, std::int64_t(length) - 1);
+        auto y = g.between(x + 1, std::int64_t(length));
+        auto letter = char('a' + g.below(26));
+        auto password = std::string(std::size_t(g.between(y, std::int64_t(length))), ' ');
+        for(auto& c : password){
+            // Often enough the letter itself, so that some passwords are valid
+            c = (g.chance(30) ? letter : char('a' + g.below(26)));
+        }
+        std::printf("%ld-%ld %c: %s\n", x, y, letter, password.c_str());
+    }
+}
+
+/*
+ * Day 03 - a map of trees
+ */
+inline void generate_03(Generator& g) noexcept{
+    auto rows = g.size(323);
+    auto width = g.at_least("width", g.knob("width", 31), 1);
+    auto density = g.knob("trees", 25);
+    for(std::size_t i = 0; i < rows; ++i){
+        auto line = std::string(width, '.');
+        for(auto& c : line){
+            c = (g.chance(density) ? '#' : '.');
+        }
+        print_lines({line});
+    }
+}
+
+/*
+ * Day 04 - passports, some with missing fields and some with invalid values
+ */
+inline std::string passport_field(Generator& g, std::size_t field, bool valid) noexcept{
+    constexpr static char const* colours[] = {"amb", "blu", "brn", "gry", "grn", "hzl", "oth"};
+    char buffer[32];
+    switch(field){
+        case 0: std::snprintf(buffer, sizeof(buffer), "byr:%ld", valid ? g.between(1920, 2002) : g.between(1900, 1919)); break;
+        case 1: std::snprintf(buffer, sizeof(buffer), "iyr:%ld", valid ? g.between(2010, 2020) : g.between(2021, 2030)); break;
+        case 2: std::snprintf(buffer, sizeof(buffer), "eyr:%ld", valid ? g.between(2020, 2030) : g.between(2031, 2040)); break;
+        case 3:
+            if(g.chance(50)){
+                std::snprintf(buffer, sizeof(buffer), "hgt:%ldcm", valid ? g.between(150, 193) : g.between(194, 250));
+            } else{
+                std::snprintf(buffer, sizeof(buffer), "hgt:%ld%s", valid ? g.between(59, 76) : g.between(59, 76), valid ? "in" : "");
+            }
+            break;
+        case 4:
+            std::snprintf(buffer, sizeof(buffer), "hcl:%s%06lx", valid ? "#" : "", std::uint64_t(g.between(0, 0xFFFFFF)));
+            break;
+        case 5: std::snprintf(buffer, sizeof(buffer), "ecl:%s", valid ? g.pick(colours) : "xyz"); break;
+        case 6: std::snprintf(buffer, sizeof(buffer), "pid:%0*ld", valid ? 9 : 10, g.between(0, 999999999)); break;
+        default: std::snprintf(buffer, sizeof(buffer), "cid:%ld", g.between(100, 350)); break;
+    }
+    return buffer;
+}
+
+inline void generate_04(Generator& g) noexcept{
+    auto n = g.size(300);
+    auto present = g.knob("present", 90);
+    auto valid = g.knob("valid", 90);
+    for(std::size_t i = 0; i < n; ++i){
+        auto fields = std::vector<std::size_t>{0, 1, 2, 3, 4, 5, 6, 7};
+        g.shuffle(fields);
+        auto line = std::string{};
+        for(auto field : fields){
+            if(!g.chance(present)){
+                continue;
+            }
+            if(!line.empty()){
+                line += (g.chance(25) ? '\n' : ' ');
+            }
+            line += passport_field(g, field, g.chance(valid));
+        }
+        print_lines({line, ""});
+    }
+}
+
+/*
+ * Day 05 - boarding passes for a run of seats with one missing, and at least
+ * eight empty seats at either end of the plane
+ * The plane has 7 bits of row and 3 of column, as in the puzzle, unless more
+ * rows are needed to seat everyone, up to the 32 bits of seat the solver takes
+ */
+inline void generate_05(Generator& g) noexcept{
+    auto n = g.at_least("passes", g.size(800), 3);
+    auto col_bits = g.within("columns", g.knob("columns", 3), 1, 16);
+    std::size_t needed = 5;
+    for(; needed < 32 && (std::uint64_t{1} << needed) < n + 17; ++needed);
+    auto row_bits = g.within("rows", g.knob("rows", std::max<std::size_t>(7, needed - std::min(needed, col_bits))),
+        col_bits < 4 ? 5 - col_bits : 1, 32 - col_bits);
+    auto bits = row_bits + col_bits;
+    n = g.within("passes", n, 3, (std::size_t{1} << bits) - 17);
+    auto lowest = g.between(8, std::int64_t((std::size_t{1} << bits) - 1 - n - 8));
+    auto mine = g.between(lowest + 1, lowest + std::int64_t(n) - 1);
+    auto seats = std::vector<std::int64_t>{};
+    for(auto seat = lowest; seat <= lowest + std::int64_t(n); ++seat){
+        if(seat != mine){
+            seats.push_back(seat);
+        }
+    }
+    g.shuffle(seats);
+    auto pass = std::string(bits, ' ');
+    for(auto seat : seats){
+        for(std::size_t i = 0; i < row_bits; ++i){
+            pass[i] = ((seat >> (bits - 1 - i)) & 1) ? 'B' : 'F';
+        }
+        for(std::size_t i = 0; i < col_bits; ++i){
+            pass[row_bits + i] = ((seat >> (col_bits - 1 - i)) & 1) ? 'R' : 'L';
+        }
+        print_lines({pass});
+    }
+}
+
+/*
+ * Day 06 - groups of answers
+ */
+inline void generate_06(Generator& g) noexcept{
+    auto n = g.size(500);
+    auto people = g.at_least("people", g.knob("people", 5), 1);
+    for(std::size_t i = 0; i < n; ++i){
+        if(i > 0){
+            print_lines({""});
+        }
+        auto common = g.word(0, 6);
+        auto size = g.between(1, std::int64_t(people));
+        for(std::int64_t j = 0; j < size; ++j){
+            auto answers = common + g.word(0, 8);
+            std::sort(answers.begin(), answers.end());
+            answers.erase(std::unique(answers.begin(), answers.end()), answers.end());
+            if(answers.empty()){
+                answers = "a";
+            }
+            g.shuffle(answers);
+            print_lines({answers});
+        }
+    }
+}
+
+/*
+ * Day 07 - bag rules, as a graph of levels where bags only contain bags from
+ * lower levels, with "shiny gold" part way up
+ * The solver allows at most 4 kinds of bag inside a bag, and 32 bags holding
+ * any one bag
+ */
+inline void generate_07(Generator& g) noexcept{
+    constexpr static char const* adjectives[] = {
+        "light", "dark", "bright", "muted", "faded", "dotted", "vibrant", "pale", "drab", "dim",
+        "clear", "dull", "mirrored", "plaid", "posh", "shiny", "striped", "wavy", "dusty", "wavy"
+    };
+    constexpr static char const* colours[] = {
+        "red", "orange", "white", "yellow", "blue", "black", "olive", "plum", "fuchsia", "tan",
+        "teal", "maroon", "lime", "cyan", "violet", "indigo", "magenta", "salmon", "bronze", "beige"
+    };
+    auto n = g.at_least("bag colours", g.size(600), 2);
+    auto depth = g.at_least("depth", g.knob("depth", 8), 2);
+    auto names = std::set<std::string>{"shiny gold"};
+    for(std::size_t suffix = 0; names.size() < n; ++suffix){
+        for(std::size_t tries = 0; tries < 4 * n && names.size() < n; ++tries){
+            auto name = std::string{g.pick(adjectives)} + " " + g.pick(colours);
+            if(suffix > 0){
+                name += std::to_string(g.below(suffix * 100));
+            }
+            names.insert(name);
+        }
+    }
+    auto bags = std::vector<std::string>(names.begin(), names.end());
+    g.shuffle(bags);
+
+    // shiny gold goes low enough that the count of bags inside it stays small
+    auto gold_level = std::min<std::size_t>(depth - 1, 5);
+    auto gold = std::size_t(std::find(bags.begin(), bags.end(), "shiny gold") - bags.begin());
+    auto levels = std::vector<std::size_t>(bags.size());
+    auto by_level = std::vector<std::vector<std::size_t>>(depth);
+    for(std::size_t i = 0; i < bags.size(); ++i){
+        levels[i] = (bags[i] == "shiny gold" ? gold_level : (i < depth ? i : g.below(depth)));
+        by_level[levels[i]].push_back(i);
+    }
+    auto parents = std::vector<std::size_t>(bags.size());
+    for(std::size_t i = 0; i < bags.size(); ++i){
+        auto line = bags[i] + " bags contain ";
+        auto kinds = (levels[i] == 0 ? 0 : g.between(1, 4));
+        auto inside = std::vector<std::size_t>{};
+        if(levels[i] > gold_level && parents[gold] < 32 && g.chance(10)){
+            inside.push_back(gold);
+            ++parents[gold];
+        }
+        for(std::int64_t k = std::int64_t(inside.size()); k < kinds; ++k){
+            auto const& level = by_level[g.below(levels[i])];
+            if(level.empty()){
+                continue;
+            }
+            auto child = g.pick(level);
+            if(parents[child] < 32 && std::find(inside.begin(), inside.end(), child) == inside.end()){
+                inside.push_back(child);
+                ++parents[child];
+            }
+        }
+        if(inside.empty()){
+            line += "no other bags.";
+        }
+        for(std::size_t k = 0; k < inside.size(); ++k){
+            auto number = g.between(1, 5);
+            line += std::to_string(number) + " " + bags[inside[k]] + (number == 1 ? " bag" : " bags");
+            line += (k + 1 < inside.size() ? ", " : ".");
+        }
+        print_lines({line});
+    }
+}
+
+/*
+ * Day 08 - boot code with one backwards `jmp` causing a loop
+ * Every other jump goes forwards and none jumps over that one, so flipping
+ * it is the only fix: every other flip still reaches it, or loops itself
+ */
+inline void generate_08(Generator& g) noexcept{
+    auto n = g.at_least("instructions", g.size(600), 4);
+    auto loop = std::size_t(g.between(std::int64_t(n / 2), std::int64_t(n) - 1));
+    auto lines = std::vector<std::string>(n);
+    auto visited = std::vector<std::size_t>{};
+    char buffer[32];
+    for(std::size_t i = 0; i < n; ++i){
+        auto limit = (i < loop ? loop : n);
+        auto kind = g.below(10);
+        if(kind < 2){
+            std::snprintf(buffer, sizeof(buffer), "nop %+ld", -g.between(0, std::int64_t(i)));
+        } else if(kind < 7 || i + 1 >= limit){
+            std::snprintf(buffer, sizeof(buffer), "acc %+ld", g.between(-50, 50));
+        } else{
+            std::snprintf(buffer, sizeof(buffer), "jmp %+ld", g.between(1, std::int64_t(limit - i)));
+        }
+        lines[i] = buffer;
+    }
+    // Only instructions that are actually run can be jumped back to
+    for(std::size_t i = 0; i < loop;){
+        visited.push_back(i);
+        auto arg = std::strtol(lines[i].c_str() + 4, nullptr, 10);
+        i += (lines[i][0] == 'j' ? std::size_t(arg) : 1);
+    }
+    auto target = (visited.empty() ? loop : g.pick(visited));
+    std::snprintf(buffer, sizeof(buffer), "jmp %+ld", -std::int64_t(loop - target));
+    lines[loop] = buffer;
+    print_lines(lines);
+}
+
+/*
+ * Day 09 - XMAS data with a preamble of 25
+ * Every number is the sum of two of the 25 before it, picked to grow as
+ * slowly as possible, except one, which is the sum of a contiguous run instead
+ * Past 1300 numbers they no longer fit in 64 bits, so the scale is capped
+ */
+inline void generate_09(Generator& g) noexcept{
+    constexpr std::size_t preamble = 25;
+    auto n = g.within("numbers", g.size(1000), preamble + 2, 1300);
+    auto invalid_at = g.within("invalid", g.knob("invalid", n * 3 / 4), preamble + 1, n - 1);
+    auto numbers = std::vector<std::uint64_t>{};
+    for(std::size_t i = 0; i < preamble; ++i){
+        numbers.push_back(std::uint64_t(g.between(1, 100)));
+    }
+    auto is_sum = [&](std::size_t i, std::uint64_t value){
+        for(auto j = i - preamble; j < i; ++j){
+            for(auto k = j + 1; k < i; ++k){
+                if(numbers[j] != numbers[k] && numbers[j] + numbers[k] == value){
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    for(auto i = preamble; i < n; ++i){
+        if(i == invalid_at){
+            while(true){
+                auto length = std::size_t(g.between(2, 17));
+                auto begin = std::size_t(g.between(0, std::int64_t(i - length)));
+                auto sum = std::accumulate(numbers.begin() + begin, numbers.begin() + begin + length, std::uint64_t{0});
+                if(!is_sum(i, sum)){
+                    numbers.push_back(sum);
+                    break;
+                }
+            }
+            continue;
+        }
+        // Sums of the smallest numbers around, so the numbers grow as slowly
+        // as they can, which is still doubling every 20 or so
+        auto smallest = std::vector<std::uint64_t>(numbers.end() - preamble, numbers.end());
+        std::sort(smallest.begin(), smallest.end());
+        smallest.erase(std::unique(smallest.begin(), smallest.end()), smallest.end());
+        auto x = g.below(std::min<std::size_t>(smallest.size() - 1, 3));
+        auto y = x + 1 + g.below(std::min<std::size_t>(smallest.size() - 1 - x, 3));
+        numbers.push_back(smallest[x] + smallest[y]);
+    }
+    for(auto number : numbers){
+        std::printf("%lu\n", number);
+    }
+}
+
+/*
+ * Day 10 - adapters, in runs of differences of 1 between differences of 3
+ * The number of arrangements multiplies with every run, so long inputs only
+ * stay within 64 bits with short runs (run=1 never grows)
+ */
+inline void generate_10(Generator& g) noexcept{
+    auto n = g.size(100);
+    auto run = g.knob("run", 4);
+    auto adapters = std::vector<std::uint64_t>{};
+    std::uint64_t joltage = 0;
+    while(adapters.size() < n){
+        joltage += 3;
+        adapters.push_back(joltage);
+        auto length = g.below(run + 1);
+        for(std::size_t i = 0; i < length && adapters.size() < n; ++i){
+            joltage += 1;
+            adapters.push_back(joltage);
+        }
+    }
+    g.shuffle(adapters);
+    for(auto adapter : adapters){
+        std::printf("%lu\n", adapter);
+    }
+}
+
+/*
+ * Day 11 - a seat layout
+ */
+inline void generate_11(Generator& g) noexcept{
+    auto rows = g.size(90);
+    auto width = g.at_least("width", g.knob("width", 95), 1);
+    auto floor = g.knob("floor", 15);
+    for(std::size_t i = 0; i < rows; ++i){
+        auto line = std::string(width, 'L');
+        for(auto& c : line){
+            c = (g.chance(floor) ? '.' : 'L');
+        }
+        print_lines({line});
+    }
+}
+
+/*
+ * Day 12 - navigation instructions
+ */
+inline void generate_12(Generator& g) noexcept{
+    auto n = g.size(780);
+    for(std::size_t i = 0; i < n; ++i){
+        auto action = "NSEWLRF"[g.below(7)];
+        auto value = (action == 'L' || action == 'R' ? 90 * g.between(1, 3) : g.between(1, 100));
+        std::printf("%c%ld\n", action, value);
+    }
+}
+
+/*
+ * Day 13 - bus timetable
+ * The bus IDs are distinct primes, each placed at an offset below its ID,
+ * with their product kept well inside 64 bits for the solver's arithmetic
+ */
+inline void generate_13(Generator& g) noexcept{
+    auto n = g.within("buses", g.size(9), 1, 200);
+    auto slots = g.within("slots", g.knob("slots", 80), n, 200);
+    auto primes = std::vector<std::uint64_t>{};
+    for(std::uint64_t p = 13; p < 1000; ++p){
+        auto prime = true;
+        for(std::uint64_t d = 2; d * d <= p && prime; ++d){
+            prime = (p % d != 0);
+        }
+        if(prime){
+            primes.push_back(p);
+        }
+    }
+    g.shuffle(primes);
+    auto timetable = std::vector<std::uint64_t>(slots, 0);
+    long double product = 1;
+    std::size_t placed = 0;
+    for(auto p : primes){
+        if(placed == n || product * p > std::ldexp(1.0L, 50)){
+            continue;
+        }
+        auto free = std::vector<std::size_t>{};
+        for(std::size_t i = (placed == 0 ? 0 : 1); i < std::min<std::size_t>(slots, p); ++i){
+            if(timetable[i] == 0){
+                free.push_back(i);
+            }
+            if(placed == 0){
+                break;
+            }
+        }
+        if(free.empty()){
+            continue;
+        }
+        timetable[g.pick(free)] = p;
+        product *= p;
+        ++placed;
+    }
+    while(timetable.back() == 0){
+        timetable.pop_back();
+    }
+    std::printf("%ld\n", g.between(100000, 10000000));
+    for(std::size_t i = 0; i < timetable.size(); ++i){
+        if(timetable[i] == 0){
+            std::printf("%sx", i == 0 ? "" : ",");
+        } else{
+            std::printf("%s%lu", i == 0 ? "" : ",", timetable[i]);
+        }
+    }
+    std::printf("\n");
+}
+
+/*
+ * Day 14 - masks and writes
+ * The solver's memory holds about 140000 addresses, and each write in part 2
+ * touches 2 to the power of the mask's X bits of them
+ */
+inline void generate_14(Generator& g) noexcept{
+    auto n = g.size(100);
+    auto xbits = g.within("xbits", g.knob("xbits", 9), 0, 36);
+    auto writes = g.at_least("writes", g.knob("writes", 5), 1);
+    std::size_t addresses = 0;
+    for(std::size_t i = 0; i < n; ++i){
+        auto mask = std::string(36, '0');
+        for(auto& c : mask){
+            c = (g.chance(50) ? '1' : '0');
+        }
+        auto xs = std::vector<std::size_t>(36);
+        std::iota(xs.begin(), xs.end(), 0);
+        g.shuffle(xs);
+        auto x = g.below(xbits + 1);
+        for(std::size_t j = 0; j < x; ++j){
+            mask[xs[j]] = 'X';
+        }
+        std::printf("mask = %s\n", mask.c_str());
+        auto count = g.between(1, std::int64_t(writes));
+        for(std::int64_t j = 0; j < count; ++j){
+            std::printf("mem[%ld] = %ld\n", g.between(1, 65535), g.between(1, 999999999));
+            addresses += std::size_t{1} << x;
+        }
+    }
+    if(addresses > 100000){
+        std::fprintf(stderr, "day 14: up to %lu addresses are written, more than the solver can hold\n", addresses);
+    }
+}
+
+/*
+ * Day 15 - distinct starting numbers
+ */
+inline void generate_15(Generator& g) noexcept{
+    auto n = g.within("starting numbers", g.size(7), 2, 100);
+    auto numbers = std::vector<std::size_t>(std::max<std::size_t>(n * 3, 20));
+    std::iota(numbers.begin(), numbers.end(), 0);
+    g.shuffle(numbers);
+    for(std::size_t i = 0; i < n; ++i){
+        std::printf("%s%lu", i == 0 ? "" : ",", numbers[i]);
+    }
+    std::printf("\n");
+}
+
+/*
+ * Day 16 - ticket fields, tickets and nearby tickets
+ * Field k accepts the values of the columns of every field ranked at or
+ * above it, so the columns resolve one at a time, lowest ranked first
+ * The solver is built for 20 fields, the first 6 of them "departure"
+ */
+inline void generate_16(Generator& g) noexcept{
+    constexpr static char const* names[] = {
+        "departure location", "departure station", "departure platform", "departure track",
+        "departure date", "departure time", "arrival location", "arrival station",
+        "arrival platform", "arrival track", "class", "duration", "price", "route", "row",
+        "seat", "train", "type", "wagon", "zone"
+    };
+    constexpr std::int64_t base = 50;
+    constexpr std::int64_t width = 20;
+    auto n = g.size(240);
+    auto fields = g.within("fields", g.knob("fields", 20), 6, 32);
+    auto invalid = g.knob("invalid", 25);
+    auto rank = std::vector<std::size_t>(fields);
+    std::iota(rank.begin(), rank.end(), 0);
+    g.shuffle(rank);
+    auto column_of = rank; // which field each column holds
+    g.shuffle(column_of);
+    auto top = base + std::int64_t(fields) * width - 1;
+
+    for(std::size_t f = 0; f < fields; ++f){
+        auto lo = base + std::int64_t(rank[f]) * width;
+        auto split = g.between(lo, top - 1);
+        auto name = (f < std::size(names) ? std::string{names[f]} : "field " + std::to_string(f));
+        std::printf("%s: %ld-%ld or %ld-%ld\n", name.c_str(), lo, split, split + 1, top);
+    }
+    auto ticket = [&](bool valid){
+        auto bad = (valid ? fields : g.below(fields));
+        for(std::size_t c = 0; c < fields; ++c){
+            auto lo = base + std::int64_t(rank[column_of[c]]) * width;
+            auto value = (c == bad
+                ? (g.chance(50) ? g.between(1, base - 1) : g.between(top + 1, 999))
+                : g.between(lo, lo + width - 1));
+            std::printf("%s%ld", c == 0 ? "" : ",", value);
+        }
+        std::printf("\n");
+    };
+    std::printf("\nyour ticket:\n");
+    ticket(true);
+    std::printf("\nnearby tickets:\n");
+    for(std::size_t i = 0; i < n; ++i){
+        ticket(!g.chance(invalid));
+    }
+}
+
+/*
+ * Day 17 - the initial slice of cubes
+ */
+inline void generate_17(Generator& g) noexcept{
+    auto size = g.at_least("grid size", g.size(8), 1);
+    auto density = g.knob("active", 40);
+    for(std::size_t i = 0; i < size; ++i){
+        auto line = std::string(size, '.');
+        for(auto& c : line){
+            c = (g.chance(density) ? '#' : '.');
+        }
+        print_lines({line});
+    }
+}
+
+/*
+ * Day 18 - expressions, kept below 10^15 with either precedence so that the
+ * sum of many of them still fits in 64 bits
+ */
+struct Expression{
+    std::string text;
+    double flat;   // + and * equal
+    double plus;   // + before *
+};
+
+inline Expression make_expression(Generator& g, std::size_t depth) noexcept{
+    auto terms = g.between(2, 6);
+    auto e = Expression{};
+    double flat = 0, product = 1, sum = 0;
+    for(std::int64_t i = 0; i < terms; ++i){
+        auto op = (i == 0 ? '+' : (g.chance(50) ? '+' : '*'));
+        auto term = Expression{};
+        if(depth > 0 && g.chance(30)){
+            auto inner = make_expression(g, depth - 1);
+            term = {"(" + inner.text + ")", inner.flat, inner.plus};
+        } else{
+            auto digit = g.between(1, 9);
+            term = {std::to_string(digit), double(digit), double(digit)};
+        }
+        e.text += (i == 0 ? "" : (op == '+' ? " + " : " * ")) + term.text;
+        flat = (op == '+' ? flat + term.flat : flat * term.flat);
+        if(op == '*'){
+            product *= sum;
+            sum = term.plus;
+        } else{
+            sum += term.plus;
+        }
+    }
+    e.flat = flat;
+    e.plus = product * sum;
+    return e;
+}
+
+inline void generate_18(Generator& g) noexcept{
+    auto n = g.size(370);
+    auto depth = g.knob("depth", 2);
+    for(std::size_t i = 0; i < n; ++i){
+        auto e = make_expression(g, depth);
+        while(e.flat >= 1e15 || e.plus >= 1e15){
+            e = make_expression(g, depth);
+        }
+        print_lines({e.text});
+    }
+}
+
+/*
+ * Day 19 - rules and messages
+ * Every rule at depth d is "a" then a rule at depth d - 1, or "b" then
+ * another, as in the puzzle, so that the first letter always decides which
+ * alternative a word takes and 42 and 31 match words of depth + 1 letters
+ * 42 starts with "a" and 31 with "b", so no word matches both
+ * Messages are 42 repeated n times then 31 repeated m times, with m < n and m
+ * within the solver's nesting of rule 11, or noise of the same lengths
+ */
+inline void generate_19(Generator& g) noexcept{
+    auto n = g.size(400);
+    auto depth = g.within("depth", g.knob("depth", 7), 1, 12);
+    auto per_level = g.within("rules", g.knob("rules", 4), 2, 20);
+    auto ids = std::vector<std::size_t>{};
+    for(std::size_t id = 1; id < 256; ++id){
+        if(id != 8 && id != 11 && id != 42 && id != 31){
+            ids.push_back(id);
+        }
+    }
+    g.shuffle(ids);
+    auto next = ids.begin();
+
+    struct Rule{
+        std::size_t id;
+        char letter;
+        std::array<std::array<std::size_t, 2>, 2> alternatives; // indices of rules
+    };
+    auto rules = std::vector<Rule>{};
+    auto const a = rules.size();
+    auto const b = rules.size() + 1;
+    auto level = std::vector<std::size_t>{a, b};
+    rules.push_back({*next++, 'a', {}});
+    rules.push_back({*next++, 'b', {}});
+    for(std::size_t d = 1; d < depth; ++d){
+        auto next_level = std::vector<std::size_t>{};
+        for(std::size_t i = 0; i < per_level; ++i){
+            next_level.push_back(rules.size());
+            rules.push_back({*next++, 0, {{{a, g.pick(level)}, {b, g.pick(level)}}}});
+        }
+        level = next_level;
+    }
+    rules.push_back({42, 0, {{{a, g.pick(level)}, {a, g.pick(level)}}}});
+    rules.push_back({31, 0, {{{b, g.pick(level)}, {b, g.pick(level)}}}});
+
+    auto lines = std::vector<std::string>{"0: 8 11", "8: 42", "11: 42 31"};
+    for(auto const& rule : rules){
+        if(rule.letter != 0){
+            lines.push_back(std::to_string(rule.id) + ": \"" + rule.letter + "\"");
+            continue;
+        }
+        auto line = std::to_string(rule.id) + ":";
+        for(std::size_t i = 0; i < 2; ++i){
+            line += (i == 0 ? " " : " | ");
+            line += std::to_string(rules[rule.alternatives[i][0]].id) + " " + std::to_string(rules[rule.alternatives[i][1]].id);
+        }
+        lines.push_back(line);
+    }
+    g.shuffle(lines);
+    lines.push_back("");
+    print_lines(lines);
+
+    auto sample = [&](auto& self, std::size_t i, std::string& out) -> void{
+        auto const& rule = rules[i];
+        if(rule.letter != 0){
+            out += rule.letter;
+            return;
+        }
+        for(auto j : g.pick(rule.alternatives)){
+            self(self, j, out);
+        }
+    };
+    auto const rule_42 = rules.size() - 2;
+    auto const rule_31 = rules.size() - 1;
+    for(std::size_t i = 0; i < n; ++i){
+        auto m = std::size_t(g.between(1, 4));
+        auto k = std::size_t(g.between(std::int64_t(m) + 1, std::int64_t(m) + 3));
+        auto message = std::string{};
+        for(std::size_t j = 0; j < k; ++j){
+            sample(sample, rule_42, message);
+        }
+        for(std::size_t j = 0; j < m; ++j){
+            sample(sample, rule_31, message);
+        }
+        if(g.chance(40)){
+            for(auto& c : message){
+                c = (g.chance(50) ? 'a' : 'b');
+            }
+        }
+        print_lines({message});
+    }
+}
+
+/*
+ * Day 20 - tiles cut from one image with sea monsters in it, each tile then
+ * flipped and rotated at random
+ * Neighbouring tiles share their borders, and no two borders are alike (nor
+ * a border and the reverse of another), so the tiles only fit one way
+ * The solver handles up to 12 by 12 tiles
+ */
+inline void generate_20(Generator& g) noexcept{
+    constexpr static char const* monster[] = {
+        "                  # ",
+        "#    ##    ##    ###",
+        " #  #  #  #  #  #   "
+    };
+    auto n = g.within("tiles per side", g.size(12), 2, 12);
+    auto size = 9 * n + 1;
+    auto density = g.knob("rough", 30);
+    auto lattice = std::vector<std::string>{};
+
+    // Borders are ten cells, two of them corners shared with other borders
+    auto make_lattice = [&]{
+        lattice.assign(size, std::string(size, '.'));
+        for(auto& row : lattice){
+            for(auto& c : row){
+                c = (g.chance(density) ? '#' : '.');
+            }
+        }
+        auto seen = std::set<std::string>{};
+        for(std::size_t i = 0; i <= n; ++i){
+            for(std::size_t j = 0; j < n; ++j){
+                for(auto horizontal : {true, false}){
+                    auto cell = [&](std::size_t k) -> char&{
+                        return horizontal ? lattice[9 * i][9 * j + k] : lattice[9 * j + k][9 * i];
+                    };
+                    auto border = std::string(10, '.');
+                    auto tries = 0;
+                    for(; tries < 1000; ++tries){
+                        for(std::size_t k = 1; k < 9; ++k){
+                            cell(k) = (g.chance(50) ? '#' : '.');
+                        }
+                        for(std::size_t k = 0; k < 10; ++k){
+                            border[k] = cell(k);
+                        }
+                        auto reversed = std::string(border.rbegin(), border.rend());
+                        if(border != reversed && !seen.count(border) && !seen.count(reversed)){
+                            seen.insert(border);
+                            break;
+                        }
+                    }
+                    if(tries == 1000){
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+    while(!make_lattice());
+
+    // Sea monsters go into the image, which is the lattice without borders
+    auto monsters = g.knob("monsters", n * n / 4 + 1);
+    auto image = [&](std::size_t y, std::size_t x) -> char&{
+        return lattice[9 * (y / 8) + 1 + y % 8][9 * (x / 8) + 1 + x % 8];
+    };
+    auto taken = std::vector<std::vector<bool>>(8 * n, std::vector<bool>(8 * n));
+    for(std::size_t m = 0, tries = 0; m < monsters && tries < 100 * monsters; ++tries){
+        auto y = g.below(8 * n - 2);
+        auto x = g.below(8 * n - 19);
+        auto free = true;
+        for(std::size_t dy = 0; dy < 3; ++dy){
+            for(std::size_t dx = 0; dx < 20; ++dx){
+                free &= !taken[y + dy][x + dx];
+            }
+        }
+        if(!free){
+            continue;
+        }
+        for(std::size_t dy = 0; dy < 3; ++dy){
+            for(std::size_t dx = 0; dx < 20; ++dx){
+                taken[y + dy][x + dx] = true;
+                if(monster[dy][dx] == '#'){
+                    image(y + dy, x + dx) = '#';
+                }
+            }
+        }
+        ++m;
+    }
+
+    auto ids = std::vector<std::size_t>(9000);
+    std::iota(ids.begin(), ids.end(), 1000);
+    g.shuffle(ids);
+    auto tiles = std::vector<std::vector<std::string>>{};
+    for(std::size_t i = 0; i < n; ++i){
+        for(std::size_t j = 0; j < n; ++j){
+            auto tile = std::vector<std::string>(10, std::string(10, '.'));
+            auto symmetry = g.below(8);
+            for(std::size_t y = 0; y < 10; ++y){
+                for(std::size_t x = 0; x < 10; ++x){
+                    auto a = (symmetry & 1 ? 9 - y : y);
+                    auto b = (symmetry & 2 ? 9 - x : x);
+                    if(symmetry & 4){
+                        std::swap(a, b);
+                    }
+                    tile[y][x] = lattice[9 * i + a][9 * j + b];
+                }
+            }
+            tiles.push_back(tile);
+        }
+    }
+    g.shuffle(tiles);
+    for(std::size_t t = 0; t < tiles.size(); ++t){
+        std::printf("%sTile %lu:\n", t == 0 ? "" : "\n", ids[t]);
+        print_lines(tiles[t]);
+    }
+}
+
+/*
+ * Day 21 - foods, with each allergen in exactly one ingredient
+ * Foods are added until the allergens resolve one at a time, as the solver
+ * expects
+ */
+inline void generate_21(Generator& g) noexcept{
+    auto n = g.size(40);
+    auto allergen_count = g.within("allergens", g.knob("allergens", 8), 1, 64);
+    auto ingredient_count = g.at_least("ingredients", g.knob("ingredients", 200), allergen_count + 1);
+    auto per_food = g.at_least("per_food", g.knob("per_food", 20), 1);
+    auto ingredients = unique_words(g, ingredient_count, 4, 8);
+    auto allergens = unique_words(g, allergen_count, 4, 9);
+    std::sort(allergens.begin(), allergens.end());
+    auto dangerous = std::vector<std::size_t>(ingredient_count);
+    std::iota(dangerous.begin(), dangerous.end(), 0);
+    g.shuffle(dangerous);
+    dangerous.resize(allergen_count);
+
+    // The ingredients each allergen could still be in
+    auto candidates = std::vector<std::set<std::size_t>>(allergen_count);
+    auto seen = std::vector<bool>(allergen_count);
+    auto resolves = [&]{
+        auto left = candidates;
+        for(std::size_t round = 0; round < allergen_count; ++round){
+            auto found = false;
+            for(std::size_t a = 0; a < allergen_count && !found; ++a){
+                if(seen[a] && left[a].size() == 1){
+                    auto ingredient = *left[a].begin();
+                    for(auto& other : left){
+                        other.erase(ingredient);
+                    }
+                    found = true;
+                }
+            }
+            if(!found){
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto lines = std::vector<std::string>{};
+    while(lines.size() < n || !resolves()){
+        auto food = std::set<std::size_t>{};
+        auto size = g.between(1, std::int64_t(per_food));
+        for(std::int64_t i = 0; i < size; ++i){
+            food.insert(g.below(ingredient_count));
+        }
+        auto listed = std::vector<std::size_t>{};
+        auto count = g.between(1, std::min<std::int64_t>(3, std::int64_t(allergen_count)));
+        for(std::int64_t i = 0; i < count; ++i){
+            auto a = g.below(allergen_count);
+            if(std::find(listed.begin(), listed.end(), a) == listed.end()){
+                listed.push_back(a);
+                food.insert(dangerous[a]);
+            }
+        }
+        std::sort(listed.begin(), listed.end());
+        for(auto a : listed){
+            if(!seen[a]){
+                candidates[a] = food;
+                seen[a] = true;
+            } else{
+                auto both = std::set<std::size_t>{};
+                std::set_intersection(candidates[a].begin(), candidates[a].end(), food.begin(), food.end(),
+                    std::inserter(both, both.begin()));
+                candidates[a] = both;
+            }
+        }
+        auto order = std::vector<std::size_t>(food.begin(), food.end());
+        g.shuffle(order);
+        auto line = std::string{};
+        for(auto i : order){
+            line += ingredients[i] + " ";
+        }
+        line += "(contains ";
+        for(std::size_t i = 0; i < listed.size(); ++i){
+            line += allergens[listed[i]] + (i + 1 < listed.size() ? ", " : ")");
+        }
+        lines.push_back(line);
+    }
+    print_lines(lines);
+}
+
+/*
+ * Day 22 - two decks dealt from the cards 1 to 2n
+ */
+inline void generate_22(Generator& g) noexcept{
+    auto n = g.at_least("cards per player", g.size(25), 1);
+    auto cards = std::vector<std::size_t>(2 * n);
+    std::iota(cards.begin(), cards.end(), 1);
+    g.shuffle(cards);
+    for(std::size_t player = 0; player < 2; ++player){
+        std::printf("%sPlayer %lu:\n", player == 0 ? "" : "\n", player + 1);
+        for(std::size_t i = 0; i < n; ++i){
+            std::printf("%lu\n", cards[player * n + i]);
+        }
+    }
+}
+
+/*
+ * Day 23 - the cups are always the digits 1 to 9, so only their order varies
+ */
+inline void generate_23(Generator& g) noexcept{
+    if(g.scale > 0){
+        std::fprintf(stderr, "day 23: there are always 9 cups, the scale of %lu is ignored\n", g.scale);
+    }
+    auto cups = std::string{"123456789"};
+    g.shuffle(cups);
+    print_lines({cups});
+}
+
+/*
+ * Day 24 - paths to tiles
+ */
+inline void generate_24(Generator& g) noexcept{
+    constexpr static char const* steps[] = {"e", "se", "sw", "w", "nw", "ne"};
+    auto n = g.size(400);
+    auto length = g.at_least("length", g.knob("length", 20), 1);
+    for(std::size_t i = 0; i < n; ++i){
+        auto line = std::string{};
+        auto count = g.between(std::int64_t(length + 1) / 2, std::int64_t(length));
+        for(std::int64_t j = 0; j < count; ++j){
+            line += g.pick(steps);
+        }
+        print_lines({line});
+    }
+}
+
+/*
+ * Day 25 - the two public keys, from loop sizes of up to the scale
+ */
+inline void generate_25(Generator& g) noexcept{
+    constexpr std::uint64_t modulus = 20201227;
+    auto loop = g.at_least("largest loop size", g.size(10000000), 1);
+    for(std::size_t k = 0; k < 2; ++k){
+        auto loop_size = g.between(1, std::int64_t(loop));
+        std::uint64_t key = 1;
+        for(std::int64_t i = 0; i < loop_size; ++i){
+            key = key * 7 % modulus;
+        }
+        std::printf("%lu\n", key);
+    }
+}
+
+/*
+ * All of them
+ */
+struct Day{
+    void (*generate)(Generator&);
+    char const* scale;
+    char const* knobs;
+};
+
+constexpr static Day days[] = {
+    {generate_01, "entries (200)", ""},
+    {generate_02, "lines (1000)", "length=20 (longest password)"},
+    {generate_03, "rows (323)", "width=31, trees=25 (%)"},
+    {generate_04, "passports (300)", "present=90 (% of fields), valid=90 (% of values)"},
+    {generate_05, "passes (800)", "rows=7, columns=3 (bits of seat, more rows if needed)"},
+    {generate_06, "groups (500)", "people=5 (most per group)"},
+    {generate_07, "bag colours (600)", "depth=8 (levels of bags)"},
+    {generate_08, "instructions (600)", ""},
+    {generate_09, "numbers (1000, at most 1300)", "invalid=3/4 of the way (index of the invalid number)"},
+    {generate_10, "adapters (100)", "run=4 (longest run of differences of 1)"},
+    {generate_11, "rows (90)", "width=95, floor=15 (%)"},
+    {generate_12, "instructions (780)", ""},
+    {generate_13, "buses (9, at most 200)", "slots=80 (entries in the timetable, at most 200)"},
+    {generate_14, "masks (100)", "xbits=9 (most X bits per mask), writes=5 (most writes per mask)"},
+    {generate_15, "starting numbers (7, at most 100)", ""},
+    {generate_16, "nearby tickets (240)", "fields=20 (the solver expects 20), invalid=25 (% of tickets)"},
+    {generate_17, "grid size (8)", "active=40 (%)"},
+    {generate_18, "expressions (370)", "depth=2 (nesting of parentheses)"},
+    {generate_19, "messages (400)", "depth=7 (42 and 31 match depth+1 letters), rules=4 (per level)"},
+    {generate_20, "tiles per side (12, at most 12)", "monsters=n*n/4+1, rough=30 (%)"},
+    {generate_21, "foods (40, more if needed)", "allergens=8, ingredients=200, per_food=20"},
+    {generate_22, "cards per player (25)", ""},
+    {generate_23, "unused (always 9 cups)", ""},
+    {generate_24, "paths (400)", "length=20 (most steps per path)"},
+    {generate_25, "largest loop size (10000000)", ""}
+};
+
+inline void usage(char const* self) noexcept{
+    std::fprintf(stderr, "usage: %s [-s seed] [-n scale] [-k knob=value]... day\n\n", self);
+    for(std::size_t i = 0; i < std::size(days); ++i){
+        std::fprintf(stderr, "  day %2lu  scale: %-32s %s\n", i + 1, days[i].scale, days[i].knobs);
+    }
+}
+
+int main(int argc, char** argv){
+    std::uint64_t seed = 2020;
+    std::size_t scale = 0;
+    auto knobs = std::vector<Knob>{};
+    for(int opt; (opt = getopt(argc, argv, "s:n:k:h")) != -1;){
+        switch(opt){
+            case 's': seed = std::strtoull(optarg, nullptr, 10); break;
+            case 'n': scale = std::strtoull(optarg, nullptr, 10); break;
+            case 'k': {
+                auto* equals = std::strchr(optarg, '=');
+                if(!equals){
+                    usage(argv[0]);
+                    return 2;
+                }
+                *equals = '\0';
+                knobs.push_back({optarg, std::strtoull(equals + 1, nullptr, 10)});
+                break;
+            }
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if(optind + 1 != argc){
+        usage(argv[0]);
+        return 2;
+    }
+    auto day = std::strtoul(argv[optind], nullptr, 10);
+    if(day < 1 || day > std::size(days)){
+        usage(argv[0]);
+        return 2;
+    }
+    auto g = Generator{std::mt19937_64{seed}, scale, knobs, unsigned(day)};
+    days[day - 1].generate(g);
+    return 0;
+}